@@ -0,0 +1,460 @@
+/*
+  ==============================================================================
+
+    Analyzer.h
+    Created: 19 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <complex>
+#include <vector>
+
+
+
+
+
+
+
+
+
+
+// Carries raw snapshots of the signals inside the DSP graph from the audio thread to
+// the analyzer worker through a lock-free single producer, single consumer ring. The
+// audio thread only copies samples in; all of the analysis happens on the worker.
+class AnalyzerFeed
+{
+public:
+ enum Signals
+ {
+  Input = 0,
+  InPhase,
+  Quadrature,
+  OutputLeft,
+  OutputRight,
+  SignalCount
+ };
+ 
+ static constexpr int RingSize = 16384;
+ 
+private:
+ juce::AbstractFifo fifo {RingSize};
+ std::array<std::vector<float>, SignalCount> rings;
+ std::atomic<bool> active {false};
+ std::atomic<double> sampleRate {44100.};
+ std::atomic<int> latency {0};
+ 
+public:
+ // The feed costs nothing on the audio thread while no analyzer is reading it. The
+ // rings are allocated when an analyzer is first opened, as most instances never show
+ // one, and are kept from then on because the audio thread may still be writing when
+ // the feed is switched off.
+ void setActive(bool shouldBeActive)
+ {
+  if (shouldBeActive && rings[0].empty())
+  {
+   for (auto &r : rings) r.resize(RingSize);
+  }
+  active.store(shouldBeActive, std::memory_order_release);
+ }
+ 
+ bool isActive() const
+ {
+  return active;
+ }
+ 
+ void setSampleRate(double newSampleRate)
+ {
+  sampleRate = newSampleRate;
+ }
+ 
+ double getSampleRate() const
+ {
+  return sampleRate;
+ }
+ 
+ // The latency of the output relative to the input, which the analysis compensates
+ // for so that the response is measured against the input that produced the output
+ void setLatency(int samples)
+ {
+  latency = samples;
+ }
+ 
+ int getLatency() const
+ {
+  return latency;
+ }
+ 
+ // Called from the audio thread. copy(signal, dest, start, count) must write count
+ // samples of the given signal, starting at sample start of the block, to dest. If
+ // the worker has fallen behind, whatever doesn't fit is dropped.
+ template <typename Copier>
+ void push(int sampleCount, Copier copy)
+ {
+  if (!active.load(std::memory_order_acquire)) return;
+  
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(sampleCount, start1, size1, start2, size2);
+  for (int s = 0; s < SignalCount; ++s)
+  {
+   if (size1 > 0) copy(s, rings[s].data() + start1, 0, size1);
+   if (size2 > 0) copy(s, rings[s].data() + start2, size1, size2);
+  }
+  fifo.finishedWrite(size1 + size2);
+ }
+ 
+ // Called from the worker. Either reads exactly sampleCount samples of every signal
+ // into dest and returns true, or reads nothing and returns false.
+ bool pull(int sampleCount, std::array<float*, SignalCount> dest)
+ {
+  if (fifo.getNumReady() < sampleCount) return false;
+  
+  int start1, size1, start2, size2;
+  fifo.prepareToRead(sampleCount, start1, size1, start2, size2);
+  for (int s = 0; s < SignalCount; ++s)
+  {
+   std::copy(rings[s].begin() + start1, rings[s].begin() + start1 + size1, dest[s]);
+   std::copy(rings[s].begin() + start2, rings[s].begin() + start2 + size2, dest[s] + size1);
+  }
+  fifo.finishedRead(size1 + size2);
+  return true;
+ }
+ 
+ // Called from the worker when it starts, so that it doesn't analyse stale audio
+ void flush()
+ {
+  fifo.finishedRead(fifo.getNumReady());
+ }
+};
+
+
+
+
+
+
+
+
+
+
+struct AnalyzerResult
+{
+ static constexpr int FFTOrder = 11;
+ static constexpr int FFTSize = 1 << FFTOrder;
+ static constexpr int Bins = FFTSize/2;
+ static constexpr int GoniometerPoints = 256;
+ 
+ double sampleRate {44100.};
+ 
+ // Phase of the quadrature signal relative to the in phase signal, in degrees. An
+ // ideal Hilbert pair sits at 90 across the band.
+ std::array<float, Bins> quadraturePhase {};
+ 
+ // Phase and magnitude of the output relative to the input, in degrees and dB
+ std::array<float, Bins> responsePhase {};
+ std::array<float, Bins> responseMagnitude {};
+ 
+ // Magnitude squared coherence between the input and the output, from 0 to 1
+ std::array<float, Bins> coherence {};
+ 
+ // Recent output samples as side against mid, for a goniometer
+ std::array<juce::Point<float>, GoniometerPoints> goniometer {};
+};
+
+
+
+
+
+
+
+
+
+
+// Runs overlapped FFTs on the analyzer feed on its own thread, so neither the audio
+// thread nor the message thread does any of the work. The cross spectra are averaged
+// over time and the results are published for the GUI to collect.
+class AnalyzerWorker : public juce::Thread
+{
+ static constexpr int FFTSize = AnalyzerResult::FFTSize;
+ static constexpr int Bins = AnalyzerResult::Bins;
+ static constexpr int Hop = FFTSize/2;
+ static constexpr int MaximumLatency = 8192;
+ static constexpr int HistorySize = FFTSize + MaximumLatency;
+ static constexpr float Smoothing = 0.2f;
+ 
+ typedef std::complex<float> Complex;
+ 
+ AnalyzerFeed &feed;
+ juce::dsp::FFT fft {AnalyzerResult::FFTOrder};
+ std::vector<float> window;
+ std::array<std::vector<float>, AnalyzerFeed::SignalCount> history;
+ std::vector<float> transform;
+ int filled {0};
+ 
+ std::vector<Complex> input;
+ std::vector<Complex> inPhase;
+ std::vector<Complex> quadrature;
+ std::vector<Complex> output;
+ 
+ std::vector<float> inputPower;
+ std::vector<float> outputPower;
+ std::vector<Complex> responseCross;
+ std::vector<Complex> quadratureCross;
+ 
+ AnalyzerResult working;
+ AnalyzerResult published;
+ juce::SpinLock publishLock;
+ std::atomic<int> version {0};
+ 
+ // Windows FFTSize samples of a signal, ending delay samples before the most recent,
+ // and writes its spectrum to dest
+ void spectrum(int signal, std::vector<Complex> &dest, int delay = 0)
+ {
+  const float *h = history[signal].data() + HistorySize - FFTSize - delay;
+  for (int i = 0; i < FFTSize; ++i) transform[i] = h[i]*window[i];
+  fft.performRealOnlyForwardTransform(transform.data(), true);
+  for (int b = 0; b < Bins; ++b) dest[b] = {transform[2*b], transform[2*b + 1]};
+ }
+ 
+ void analyse()
+ {
+  spectrum(AnalyzerFeed::Input, input, juce::jlimit(0, MaximumLatency, feed.getLatency()));
+  spectrum(AnalyzerFeed::InPhase, inPhase);
+  spectrum(AnalyzerFeed::Quadrature, quadrature);
+  spectrum(AnalyzerFeed::OutputLeft, output);
+  
+  for (int b = 0; b < Bins; ++b)
+  {
+   inputPower[b] += Smoothing*(std::norm(input[b]) - inputPower[b]);
+   outputPower[b] += Smoothing*(std::norm(output[b]) - outputPower[b]);
+   responseCross[b] += Smoothing*(std::conj(input[b])*output[b] - responseCross[b]);
+   quadratureCross[b] += Smoothing*(std::conj(inPhase[b])*quadrature[b] - quadratureCross[b]);
+   
+   constexpr float tiny = 1e-12f;
+   working.quadraturePhase[b] = std::arg(quadratureCross[b])*180.f/juce::MathConstants<float>::pi;
+   working.responsePhase[b] = std::arg(responseCross[b])*180.f/juce::MathConstants<float>::pi;
+   working.responseMagnitude[b] = juce::Decibels::gainToDecibels(std::sqrt((outputPower[b] + tiny)/(inputPower[b] + tiny)));
+   working.coherence[b] = std::norm(responseCross[b])/(inputPower[b]*outputPower[b] + tiny);
+  }
+  
+  const std::vector<float> &l = history[AnalyzerFeed::OutputLeft];
+  const std::vector<float> &r = history[AnalyzerFeed::OutputRight];
+  constexpr int stride = Hop/AnalyzerResult::GoniometerPoints;
+  for (int p = 0; p < AnalyzerResult::GoniometerPoints; ++p)
+  {
+   const int i = HistorySize - Hop + p*stride;
+   working.goniometer[p] = {juce::MathConstants<float>::sqrt2*0.5f*(l[i] - r[i]),
+                            juce::MathConstants<float>::sqrt2*0.5f*(l[i] + r[i])};
+  }
+  working.sampleRate = feed.getSampleRate();
+  
+  {
+   const juce::SpinLock::ScopedLockType lock(publishLock);
+   published = working;
+  }
+  ++version;
+ }
+ 
+public:
+ AnalyzerWorker(AnalyzerFeed &f) :
+ juce::Thread("PhaseRotator Analyzer"),
+ feed(f),
+ window(FFTSize),
+ transform(2*FFTSize),
+ input(Bins),
+ inPhase(Bins),
+ quadrature(Bins),
+ output(Bins),
+ inputPower(Bins),
+ outputPower(Bins),
+ responseCross(Bins),
+ quadratureCross(Bins)
+ {
+  juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), FFTSize, juce::dsp::WindowingFunction<float>::hann, false);
+  for (auto &h : history) h.resize(HistorySize);
+ }
+ 
+ ~AnalyzerWorker() override
+ {
+  stopThread(1000);
+ }
+ 
+ void run() override
+ {
+  feed.flush();
+  filled = 0;
+  
+  while (!threadShouldExit())
+  {
+   // Slide every signal along by a hop and read the next hop onto the end
+   std::array<float*, AnalyzerFeed::SignalCount> dest;
+   for (int s = 0; s < AnalyzerFeed::SignalCount; ++s) dest[s] = history[s].data() + HistorySize - Hop;
+   
+   if (!feed.pull(Hop, dest))
+   {
+    wait(20);
+    continue;
+   }
+   
+   filled = std::min(filled + Hop, HistorySize);
+   if (filled == HistorySize) analyse();
+   
+   for (auto &h : history) std::copy(h.begin() + Hop, h.end(), h.begin());
+  }
+ }
+ 
+ // Called from the GUI. Copies the latest result into dest if it is newer than
+ // lastVersion, and returns whether it did.
+ bool collect(AnalyzerResult &dest, int &lastVersion)
+ {
+  const int v = version;
+  if (v == lastVersion) return false;
+  
+  const juce::SpinLock::ScopedLockType lock(publishLock);
+  dest = published;
+  lastVersion = v;
+  return true;
+ }
+};
+
+
+
+
+
+
+
+
+
+
+// Draws the analyzer results: the quadrature phase, the output phase and magnitude
+// relative to the input and the input/output coherence on a log frequency axis, and a
+// goniometer of the output. The paths are rebuilt only when a new result arrives.
+class AnalyzerView : public juce::Component
+{
+ AnalyzerResult result;
+ juce::Path quadraturePath;
+ juce::Path responsePath;
+ juce::Path magnitudePath;
+ juce::Path coherencePath;
+ juce::Path goniometerPath;
+ juce::Rectangle<float> responseArea;
+ juce::Rectangle<float> goniometerArea;
+ 
+ static constexpr float LowestFrequency = 10.f;
+ 
+ // The magnitude is drawn with 0dB on the centre line and this many dB to the top
+ static constexpr float MagnitudeRange = 12.f;
+ 
+ float frequencyToX(float frequency) const
+ {
+  const float nyquist = 0.5f*static_cast<float>(result.sampleRate);
+  const float position = std::log(frequency/LowestFrequency)/std::log(nyquist/LowestFrequency);
+  return responseArea.getX() + position*responseArea.getWidth();
+ }
+ 
+ // Builds a path with at most one point per pixel column, averaging the bins that
+ // share a column
+ template <typename Mapping>
+ void buildPath(juce::Path &path, const std::array<float, AnalyzerResult::Bins> &data, Mapping toY)
+ {
+  path.clear();
+  const float binWidth = static_cast<float>(result.sampleRate)/AnalyzerResult::FFTSize;
+  int column = -1;
+  float sum = 0.f;
+  int count = 0;
+  for (int b = 1; b < AnalyzerResult::Bins; ++b)
+  {
+   const float f = b*binWidth;
+   if (f < LowestFrequency) continue;
+   const int x = static_cast<int>(frequencyToX(f));
+   if (x != column && count > 0)
+   {
+    const float y = toY(sum/count);
+    if (path.isEmpty()) path.startNewSubPath(column, y);
+    else path.lineTo(column, y);
+    sum = 0.f;
+    count = 0;
+   }
+   column = x;
+   sum += data[b];
+   ++count;
+  }
+  if (count > 0 && !path.isEmpty()) path.lineTo(column, toY(sum/count));
+ }
+ 
+ void rebuildPaths()
+ {
+  const float top = responseArea.getY();
+  const float height = responseArea.getHeight();
+  auto phaseToY = [=](float degrees) { return top + (0.5f - degrees/360.f)*height; };
+  auto unitToY = [=](float unit) { return top + (1.f - unit)*height; };
+  auto decibelsToY = [=](float dB) { return top + (0.5f - 0.5f*juce::jlimit(-1.f, 1.f, dB/MagnitudeRange))*height; };
+  buildPath(quadraturePath, result.quadraturePhase, phaseToY);
+  buildPath(responsePath, result.responsePhase, phaseToY);
+  buildPath(magnitudePath, result.responseMagnitude, decibelsToY);
+  buildPath(coherencePath, result.coherence, unitToY);
+  
+  goniometerPath.clear();
+  const juce::Point<float> centre = goniometerArea.getCentre();
+  const float scale = 0.5f*goniometerArea.getWidth();
+  for (const auto &p : result.goniometer)
+  {
+   const float x = centre.x + juce::jlimit(-1.f, 1.f, p.x)*scale;
+   const float y = centre.y - juce::jlimit(-1.f, 1.f, p.y)*scale;
+   goniometerPath.addRectangle(x, y, 1.f, 1.f);
+  }
+ }
+ 
+public:
+ AnalyzerView()
+ {
+  setOpaque(true);
+ }
+ 
+ void setResult(const AnalyzerResult &newResult)
+ {
+  result = newResult;
+  rebuildPaths();
+  repaint();
+ }
+ 
+ void resized() override
+ {
+  auto bounds = getLocalBounds().toFloat();
+  goniometerArea = bounds.removeFromRight(bounds.getHeight()).reduced(2.f);
+  responseArea = bounds.reduced(2.f);
+  rebuildPaths();
+ }
+ 
+ void paint(juce::Graphics &g) override
+ {
+  g.fillAll(juce::Colours::black);
+  
+  // Guide lines at 0 and 90 degrees, which is also 0 and +6dB, and around the
+  // goniometer
+  g.setColour(juce::Colours::white.withBrightness(0.25));
+  const float centreY = responseArea.getCentreY();
+  const float quarterY = centreY - 0.25f*responseArea.getHeight();
+  g.drawHorizontalLine(static_cast<int>(centreY), responseArea.getX(), responseArea.getRight());
+  g.drawHorizontalLine(static_cast<int>(quarterY), responseArea.getX(), responseArea.getRight());
+  for (float f : {100.f, 1000.f, 10000.f})
+  {
+   if (f < 0.5f*result.sampleRate) g.drawVerticalLine(static_cast<int>(frequencyToX(f)), responseArea.getY(), responseArea.getBottom());
+  }
+  g.drawEllipse(goniometerArea, 1.f);
+  
+  g.setColour(juce::Colours::grey);
+  g.strokePath(coherencePath, juce::PathStrokeType(1.f));
+  g.setColour(juce::Colours::cyan);
+  g.strokePath(magnitudePath, juce::PathStrokeType(1.f));
+  g.setColour(juce::Colours::yellow);
+  g.strokePath(quadraturePath, juce::PathStrokeType(1.f));
+  g.setColour(juce::Colours::white);
+  g.strokePath(responsePath, juce::PathStrokeType(1.f));
+  g.fillPath(goniometerPath);
+ }
+};
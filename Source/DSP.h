@@ -1,192 +1,1918 @@
-/*
-  ==============================================================================
-
-    DSP.h
-    Created: 15 Jan 2024 7:20:30pm
-    Author:  Adam Jackson
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include "XDDSP/XDDSP.h"
-
-
-
-
-
-
-
-
-
-
-namespace XDDSP
-{
-
-
-
-
-
-
-
-
-
-
-template <typename SignalXIn, typename SignalYIn, typename RotationIn,
-int StepSize = IntegerMaximum>
-class Rotator : public Component<Rotator<SignalXIn, SignalYIn, RotationIn, StepSize>>
-{
- // Private data members here
-public:
- static constexpr int Count = SignalXIn::Count;
- 
- // Specify your inputs as public members here
- SignalXIn signalXIn;
- SignalYIn signalYIn;
- RotationIn rotationIn;
-
- // Specify your outputs like this
- Output<Count> signalOut;
- 
- // Include a definition for each input in the constructor
- Rotator(Parameters &p,
-         SignalXIn _signalXIn,
-         SignalYIn _signalYIn,
-         RotationIn _rotationIn) :
- signalXIn(_signalXIn),
- signalYIn(_signalYIn),
- rotationIn(_rotationIn),
- signalOut(p)
- {}
- 
- // This function is responsible for clearing the output buffers to a default state when
- // the component is disabled.
- void reset()
- {
-  signalOut.reset();
- }
- 
- // startProcess prepares the component for processing one block and returns the step
- // size. By default, it returns the entire sampleCount as one big step.
-// int startProcess(int startPoint, int sampleCount)
-// { return std::min(sampleCount, StepSize); }
-
- // stepProcess is called repeatedly with the start point incremented by step size
- void stepProcess(int startPoint, int sampleCount)
- {
-  for (int c = 0; c < Count; ++c)
-  {
-   SampleType cc = cos(rotationIn(c, 0));
-   SampleType cs = sin(rotationIn(c, 0));
-   for (int i = startPoint, s = sampleCount; s--; ++i)
-   {
-    signalOut.buffer(c, i) = cc*signalXIn(c, i) + cs*signalYIn(c, i);
-   }
-  }
- }
- 
- // finishProcess is called after the block has been processed
-// void finishProcess()
-// {}
-};
-
- 
- 
- 
- 
- 
- 
- 
- 
- 
-class PhaseRotatorDSP : public Component<PhaseRotatorDSP>
-{
- // Private data members here
-public:
- static constexpr int Count = 2;
- 
- // Specify your inputs as public members here
- BufferCoupler<float, 2> floatInput;
- 
- SignalProbe<Connector<2>> inputProbe;
- 
- IIRHilbertApproximator<Connector<2>> hil;
- ConvolutionHilbertFilter<Connector<2>, 255> f255;
- ConvolutionHilbertFilter<Connector<2>, 1023> f1023;
- ConvolutionHilbertFilter<Connector<2>, 2047> f2047;
-
- typedef Switch<4, 2> RotatorInputSwitch;
- 
- Rotator<RotatorInputSwitch, RotatorInputSwitch, ControlConstant<2>> rotator;
- 
- SignalProbe<Connector<2>> outputProbe;
- 
- // Include a definition for each input in the constructor
- PhaseRotatorDSP(Parameters &p) :
- inputProbe(p, floatInput),
- hil(p, floatInput),
- f255(p, floatInput),
- f1023(p, floatInput),
- f2047(p, floatInput),
- rotator(p,
-         {{&hil.inPhaseOut, &f255.inPhaseOut, &f1023.inPhaseOut, &f2047.inPhaseOut}},
-         {{&hil.quadratureOut, &f255.quadratureOut, &f1023.quadratureOut, &f2047.quadratureOut}}, {0.}),
- outputProbe(p, rotator.signalOut)
- {}
- 
- void setMode(int mode)
- {
-  hil.setEnabled(mode == 0);
-  f255.setEnabled(mode == 1);
-  f1023.setEnabled(mode == 2);
-  f2047.setEnabled(mode == 3);
-  rotator.signalXIn.select(mode);
-  rotator.signalYIn.select(mode);
- }
- 
- // This function is responsible for clearing the output buffers to a default state when
- // the component is disabled.
- void reset()
- {
-  inputProbe.reset();
-  hil.reset();
-  f255.reset();
-  f1023.reset();
-  f2047.reset();
-  rotator.reset();
-  outputProbe.reset();
- }
- 
- // startProcess prepares the component for processing one block and returns the step
- // size. By default, it returns the entire sampleCount as one big step.
-// int startProcess(int startPoint, int sampleCount)
-// { return std::min(sampleCount, StepSize); }
-
- // stepProcess is called repeatedly with the start point incremented by step size
- void stepProcess(int startPoint, int sampleCount)
- {
-  inputProbe.process(startPoint, sampleCount);
-  hil.process(startPoint, sampleCount);
-  f255.process(startPoint, sampleCount);
-  f1023.process(startPoint, sampleCount);
-  f2047.process(startPoint, sampleCount);
-  rotator.process(startPoint, sampleCount);
-  outputProbe.process(startPoint, sampleCount);
- }
- 
- // finishProcess is called after the block has been processed
-// void finishProcess()
-// {}
-};
-
- 
- 
- 
- 
- 
- 
- 
- 
- 
-}
+/*
+  ==============================================================================
+
+    DSP.h
+    Created: 15 Jan 2024 7:20:30pm
+    Author:  Adam Jackson
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "XDDSP/XDDSP.h"
+#include "HilbertKernels.h"
+#include <atomic>
+#include <cmath>
+
+
+
+
+
+
+
+
+
+
+namespace XDDSP
+{
+
+
+
+
+
+
+
+
+
+
+// FIR Hilbert transformer built on a kernel from HilbertKernels.h. The kernel is shared,
+// read-only data generated at compile time, so the only memory a filter needs is its
+// history, and that isn't allocated until allocate() is called. The input history is
+// split by the parity of time so that each output is one contiguous dot product over
+// half the filter length.
+template <typename SignalIn, int Length, HilbertWindow Window = HilbertWindow::Blackman>
+class FIRHilbertFilter : public Component<FIRHilbertFilter<SignalIn, Length, Window>>
+{
+ // Private data members here
+ typedef HilbertKernel<Length, Window> Kernel;
+ static constexpr int Taps = Kernel::Taps;
+ 
+ const double *kernel {Kernel::weights.data()};
+ 
+ // For each channel and parity, a ring of Taps samples stored twice over so that the
+ // most recent Taps samples are always contiguous
+ std::vector<SampleType> history;
+ std::atomic<bool> allocated {false};
+ std::array<int, 2> position {0, 0};
+ int parity {0};
+ 
+ SampleType *stream(int c, int p)
+ {
+  return history.data() + (2*c + p)*2*Taps;
+ }
+ 
+ // Adds one sample of every channel to the history, and returns the position it was
+ // written at
+ int write(int i)
+ {
+  const int p = parity;
+  const int pos = position[p];
+  for (int c = 0; c < Count; ++c)
+  {
+   SampleType *w = stream(c, p);
+   const SampleType x = signalIn(c, i);
+   w[pos] = x;
+   w[pos + Taps] = x;
+  }
+  position[p] = (pos + 1) % Taps;
+  parity ^= 1;
+  return pos;
+ }
+ 
+public:
+ static constexpr int Count = SignalIn::Count;
+ static constexpr int DelayLength = Kernel::DelayLength;
+ 
+ // Specify your inputs as public members here
+ SignalIn signalIn;
+ 
+ // Specify your outputs like this
+ Output<Count> inPhaseOut;
+ Output<Count> quadratureOut;
+ 
+ // Include a definition for each input in the constructor
+ FIRHilbertFilter(Parameters &p, SignalIn _signalIn) :
+ signalIn(_signalIn),
+ inPhaseOut(p),
+ quadratureOut(p)
+ {}
+ 
+ // Allocates the history. Call this off the audio thread; it is safe to call while the
+ // audio thread is processing. Until then the filter outputs silence.
+ void allocate()
+ {
+  if (allocated.load(std::memory_order_acquire)) return;
+  history.assign(Count*2*2*Taps, 0.);
+  allocated.store(true, std::memory_order_release);
+ }
+ 
+ bool isAllocated() const
+ {
+  return allocated.load(std::memory_order_acquire);
+ }
+ 
+ // Runs the input into the history without computing any output. This keeps a filter
+ // that isn't in use ready to take over with a full history, for a fraction of the
+ // cost of running it.
+ void prime(int startPoint, int sampleCount)
+ {
+  if (!isAllocated()) return;
+  for (int i = startPoint, s = sampleCount; s--; ++i) write(i);
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  if (isAllocated()) std::fill(history.begin(), history.end(), 0.);
+  inPhaseOut.reset();
+  quadratureOut.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+// int startProcess(int startPoint, int sampleCount)
+// { return std::min(sampleCount, StepSize); }
+
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  if (!isAllocated())
+  {
+   for (int c = 0; c < Count; ++c)
+   {
+    for (int i = startPoint, s = sampleCount; s--; ++i)
+    {
+     inPhaseOut.buffer(c, i) = 0.;
+     quadratureOut.buffer(c, i) = 0.;
+    }
+   }
+   return;
+  }
+  
+  for (int i = startPoint, s = sampleCount; s--; ++i)
+  {
+   // The newest sample goes into the stream for its own parity. The quadrature taps
+   // all lie on the stream whose newest sample is DelayLength - nmax samples old, and
+   // the in phase output is the sample DelayLength old, which lies on the other one.
+   const int p = parity;
+   const int q = (p + DelayLength + 1) & 1;
+   const int r = q ^ 1;
+   const int inPhaseAge = (DelayLength - ((r == p) ? 0 : 1))/2;
+   const int pos = write(i);
+   const int quadraturePos = (q == p) ? (pos + 1) % Taps : position[q];
+   const int inPhasePos = (r == p) ? (pos + 1) % Taps : position[r];
+   
+   for (int c = 0; c < Count; ++c)
+   {
+    const SampleType *h = stream(c, q) + quadraturePos;
+    SampleType y = 0.;
+    for (int k = 0; k < Taps; ++k) y += kernel[k]*h[k];
+    quadratureOut.buffer(c, i) = y;
+    
+    inPhaseOut.buffer(c, i) = stream(c, r)[inPhasePos + Taps - 1 - inPhaseAge];
+   }
+  }
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+
+
+
+
+
+
+
+
+
+// FIR Hilbert transformer whose length is chosen at run time, up to MaximumLength. New
+// kernels are built off the audio thread and handed over at the start of a block by
+// swapping two vectors under a flag that the audio thread only ever tries, so the
+// audio thread never allocates or waits. The history is split by parity as in
+// FIRHilbertFilter, but each ring always holds enough samples for the longest kernel,
+// so a new kernel carries on from the same history without a gap.
+template <typename SignalIn, int MaximumLength, HilbertWindow Window = HilbertWindow::Blackman>
+class VariableHilbertFilter : public Component<VariableHilbertFilter<SignalIn, MaximumLength, Window>>
+{
+ // Private data members here
+ static constexpr int MaximumTaps = HilbertKernelDetail::tapCount(MaximumLength);
+ 
+ struct Kernel
+ {
+  std::vector<SampleType> weights;
+  int length {0};
+ };
+ 
+ // The audio thread owns kernel. pending is guarded by the handover flag.
+ Kernel kernel;
+ Kernel pending;
+ bool hasPending {false};
+ std::atomic_flag handover = ATOMIC_FLAG_INIT;
+ std::atomic<int> requestedLength {0};
+ 
+ int taps {0};
+ int delayLength {0};
+ std::vector<SampleType> history;
+ std::array<int, 2> position {0, 0};
+ int parity {0};
+ 
+ SampleType *stream(int c, int p)
+ {
+  return history.data() + (2*c + p)*2*MaximumTaps;
+ }
+ 
+ void adoptKernel()
+ {
+  taps = HilbertKernelDetail::tapCount(kernel.length);
+  delayLength = (kernel.length - 1)/2;
+ }
+ 
+public:
+ static constexpr int Count = SignalIn::Count;
+ static constexpr int MinimumLength = 63;
+ 
+ // Specify your inputs as public members here
+ SignalIn signalIn;
+ 
+ // Specify your outputs like this
+ Output<Count> inPhaseOut;
+ Output<Count> quadratureOut;
+ 
+ // Include a definition for each input in the constructor
+ VariableHilbertFilter(Parameters &p, SignalIn _signalIn, int initialLength = 255) :
+ history(Count*2*2*MaximumTaps, 0.),
+ signalIn(_signalIn),
+ inPhaseOut(p),
+ quadratureOut(p)
+ {
+  setLength(initialLength);
+  std::swap(kernel, pending);
+  hasPending = false;
+  adoptKernel();
+ }
+ 
+ // Returns the shortest length that keeps the quadrature gain within 0.1% of unity
+ // down to the given frequency. A Blackman windowed kernel of length N reaches that
+ // at about 2.6 fs/N. Lengths are rounded up to a multiple of 32, less one, so that
+ // small changes in frequency don't cause a rebuild.
+ static int lengthForFrequency(SampleType sampleRate, SampleType lowestFrequency)
+ {
+  const SampleType n = 2.6*sampleRate/std::max(SampleType(1.), lowestFrequency);
+  const int length = 32*static_cast<int>(std::min(SampleType(MaximumLength + 1), ceil((n + 1.)/32.))) - 1;
+  return std::max(MinimumLength, std::min(MaximumLength, length));
+ }
+ 
+ // Builds a kernel of the given odd length and queues it for the audio thread. Call
+ // this from any thread except the audio thread.
+ void setLength(int length)
+ {
+  length = std::max(MinimumLength, std::min(MaximumLength, length)) | 1;
+  Kernel k;
+  k.weights.resize(HilbertKernelDetail::tapCount(length));
+  makeHilbertKernel(k.weights.data(), length, Window);
+  k.length = length;
+  
+  while (handover.test_and_set(std::memory_order_acquire));
+  std::swap(pending, k);
+  hasPending = true;
+  handover.clear(std::memory_order_release);
+  requestedLength = length;
+  // k now holds any kernel that was never taken up, or the one before that, and is
+  // freed here rather than on the audio thread
+ }
+ 
+ // The length most recently asked for, which is in use once the audio thread has
+ // taken it up
+ int getLength() const
+ {
+  return requestedLength;
+ }
+ 
+ // Takes up a kernel queued by setLength, if there is one and it can be had without
+ // waiting. Returns true if the kernel, and so the delay, changed. Call this on the
+ // audio thread; process() calls it at the start of every block.
+ bool updateKernel()
+ {
+  bool changed = false;
+  if (!handover.test_and_set(std::memory_order_acquire))
+  {
+   if (hasPending)
+   {
+    std::swap(kernel, pending);
+    hasPending = false;
+    changed = kernel.length != pending.length;
+    adoptKernel();
+   }
+   handover.clear(std::memory_order_release);
+  }
+  return changed;
+ }
+ 
+ // The latency of the kernel in use, which only changes in updateKernel. Read it on
+ // the audio thread.
+ int getDelayLength() const
+ {
+  return delayLength;
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  std::fill(history.begin(), history.end(), 0.);
+  position = {0, 0};
+  parity = 0;
+  inPhaseOut.reset();
+  quadratureOut.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+ int startProcess(int startPoint, int sampleCount)
+ {
+  updateKernel();
+  return sampleCount;
+ }
+ 
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  const SampleType *k = kernel.weights.data();
+  for (int i = startPoint, s = sampleCount; s--; ++i)
+  {
+   // As in FIRHilbertFilter, but the rings are MaximumTaps long whatever the kernel
+   // length, and each read is placed back from the newest sample of its stream.
+   // Indices from MaximumTaps up address the second copy of each ring.
+   const int p = parity;
+   const int q = (p + delayLength + 1) & 1;
+   const int r = q ^ 1;
+   const int inPhaseAge = (delayLength - ((r == p) ? 0 : 1))/2;
+   const int pos = position[p];
+   const int quadratureNewest = ((q == p) ? pos : position[q] - 1) + MaximumTaps;
+   const int inPhaseNewest = ((r == p) ? pos : position[r] - 1) + MaximumTaps;
+   
+   for (int c = 0; c < Count; ++c)
+   {
+    SampleType *w = stream(c, p);
+    const SampleType x = signalIn(c, i);
+    w[pos] = x;
+    w[pos + MaximumTaps] = x;
+    
+    const SampleType *h = stream(c, q) + quadratureNewest - taps + 1;
+    SampleType y = 0.;
+    for (int j = 0; j < taps; ++j) y += k[j]*h[j];
+    quadratureOut.buffer(c, i) = y;
+    
+    inPhaseOut.buffer(c, i) = stream(c, r)[inPhaseNewest - inPhaseAge];
+   }
+   
+   position[p] = (pos + 1) % MaximumTaps;
+   parity ^= 1;
+  }
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+
+
+
+
+
+
+
+
+
+template <int Count>
+class ControlGlide : public Component<ControlGlide<Count>>
+{
+ // Private data members here
+ Parameters &param;
+ std::array<SampleType, Count> target;
+ std::array<SampleType, Count> current;
+ SampleType glideTime {0.02};
+ SampleType coefficient {0.};
+ SampleType coefficientSampleRate {0.};
+ SampleType period {0.};
+ 
+public:
+ // Specify your outputs like this
+ Output<Count> controlOut;
+ 
+ // Include a definition for each input in the constructor
+ ControlGlide(Parameters &p, SampleType initial = 0.) :
+ param(p),
+ controlOut(p)
+ {
+  target.fill(initial);
+  current.fill(initial);
+ }
+ 
+ // Sets the time constant of the glide in seconds
+ void setGlideTime(SampleType seconds)
+ {
+  glideTime = seconds;
+  coefficientSampleRate = 0.;
+ }
+ 
+ // For a control that wraps around, such as an angle, sets the period it wraps at.
+ // The glide then takes the short way round, so going from just below the period to
+ // just above zero is a small step rather than a sweep back through every value.
+ void setPeriod(SampleType p)
+ {
+  period = p;
+ }
+ 
+ void setControl(SampleType value)
+ {
+  target.fill(value);
+ }
+ 
+ void setControl(int channel, SampleType value)
+ {
+  target[channel] = value;
+ }
+ 
+ SampleType getControl(int channel) const
+ {
+  return target[channel];
+ }
+ 
+ // Jump straight to the target without gliding
+ void snap()
+ {
+  current = target;
+ }
+ 
+ // Glide towards the target from the given value
+ void startFrom(int channel, SampleType value)
+ {
+  current[channel] = value;
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  current = target;
+  controlOut.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+ int startProcess(int startPoint, int sampleCount)
+ {
+  if (coefficientSampleRate != param.sampleRate())
+  {
+   coefficientSampleRate = param.sampleRate();
+   coefficient = 1. - exp(-1./(glideTime*coefficientSampleRate));
+  }
+  return sampleCount;
+ }
+
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  for (int c = 0; c < Count; ++c)
+  {
+   SampleType t = target[c];
+   SampleType x = current[c];
+   if (x == t)
+   {
+    for (int i = startPoint, s = sampleCount; s--; ++i) controlOut.buffer(c, i) = t;
+   }
+   else
+   {
+    // Start from whichever equivalent of the current value is nearest the target
+    if (period > 0.) x = t - std::remainder(t - x, period);
+    for (int i = startPoint, s = sampleCount; s--; ++i)
+    {
+     x += coefficient*(t - x);
+     controlOut.buffer(c, i) = x;
+    }
+    // Settle exactly on the target once the difference is inaudible
+    if (fabs(t - x) < 1e-6) x = t;
+    current[c] = x;
+   }
+  }
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+
+
+
+
+
+
+
+
+
+// Selects one of several outputs, like Switch, and also hands out a pointer to the
+// selected output's samples so that a reader can run a plain loop over them. Each
+// channel of an Output is a contiguous run of samples.
+template <int Inputs, int ChannelCount>
+class OutputSwitch
+{
+ std::array<Output<ChannelCount>*, Inputs> outputs;
+ int selected {0};
+ 
+public:
+ static constexpr int Count = ChannelCount;
+ 
+ OutputSwitch(std::array<Output<ChannelCount>*, Inputs> _outputs) :
+ outputs(_outputs)
+ {}
+ 
+ void select(int input)
+ {
+  selected = input;
+ }
+ 
+ SampleType operator()(int channel, int index)
+ {
+  return outputs[selected]->buffer(channel, index);
+ }
+ 
+ // Returns the samples of one channel of the selected output, from index onwards
+ const SampleType *pointer(int channel, int index)
+ {
+  return &outputs[selected]->buffer(channel, index);
+ }
+};
+
+
+
+
+
+
+
+
+
+
+template <typename SignalXIn, typename SignalYIn, typename RotationIn,
+int ControlInterval = 32>
+class Rotator : public Component<Rotator<SignalXIn, SignalYIn, RotationIn, ControlInterval>>
+{
+ // Private data members here
+public:
+ static constexpr int Count = SignalXIn::Count;
+ 
+private:
+ typedef std::array<SampleType, Count> Coefficients;
+ typedef std::array<SampleType, ControlInterval> Ramp;
+ 
+ bool midSide {false};
+ 
+ // Fills in the cos and sin of the angle at each sample of a control interval. The
+ // angle moves linearly, so each sample's coefficients are the last sample's turned
+ // by a complex multiply, and sin and cos are only evaluated at the control points.
+ static void makeRamp(int sampleCount, SampleType c, SampleType s,
+                      SampleType dc, SampleType ds, bool constant,
+                      Ramp &rc, Ramp &rs)
+ {
+  if (constant)
+  {
+   std::fill(rc.begin(), rc.begin() + sampleCount, c);
+   std::fill(rs.begin(), rs.begin() + sampleCount, s);
+   return;
+  }
+  for (int k = 0; k < sampleCount; ++k)
+  {
+   rc[k] = c;
+   rs[k] = s;
+   const SampleType t = c*dc - s*ds;
+   s = s*dc + c*ds;
+   c = t;
+  }
+ }
+ 
+ // The rotation itself is a plain loop over raw pointers, which the compiler can
+ // vectorise
+ void rotate(int startPoint, int sampleCount,
+             const Coefficients &cc, const Coefficients &cs,
+             const Coefficients &dc, const Coefficients &ds,
+             bool constant)
+ {
+  Ramp rc, rs;
+  for (int c = 0; c < Count; ++c)
+  {
+   makeRamp(sampleCount, cc[c], cs[c], dc[c], ds[c], constant, rc, rs);
+   const SampleType *x = signalXIn.pointer(c, startPoint);
+   const SampleType *y = signalYIn.pointer(c, startPoint);
+   SampleType *out = &signalOut.buffer(c, startPoint);
+   for (int k = 0; k < sampleCount; ++k) out[k] = rc[k]*x[k] + rs[k]*y[k];
+  }
+ }
+ 
+ // Channel 0 is the mid rotation and channel 1 is the side rotation. The encode and
+ // decode are folded into the rotation, which is linear, so the analytic pair is
+ // encoded rather than the input.
+ void rotateMidSide(int startPoint, int sampleCount,
+                    const Coefficients &cc, const Coefficients &cs,
+                    const Coefficients &dc, const Coefficients &ds,
+                    bool constant)
+ {
+  static_assert(Count == 2, "Mid/side rotation needs exactly two channels");
+  Ramp mc, ms, sc, ss;
+  makeRamp(sampleCount, cc[0], cs[0], dc[0], ds[0], constant, mc, ms);
+  makeRamp(sampleCount, cc[1], cs[1], dc[1], ds[1], constant, sc, ss);
+  const SampleType *xl = signalXIn.pointer(0, startPoint);
+  const SampleType *xr = signalXIn.pointer(1, startPoint);
+  const SampleType *yl = signalYIn.pointer(0, startPoint);
+  const SampleType *yr = signalYIn.pointer(1, startPoint);
+  SampleType *left = &signalOut.buffer(0, startPoint);
+  SampleType *right = &signalOut.buffer(1, startPoint);
+  for (int k = 0; k < sampleCount; ++k)
+  {
+   const SampleType m = 0.5*(mc[k]*(xl[k] + xr[k]) + ms[k]*(yl[k] + yr[k]));
+   const SampleType sd = 0.5*(sc[k]*(xl[k] - xr[k]) + ss[k]*(yl[k] - yr[k]));
+   left[k] = m + sd;
+   right[k] = m - sd;
+  }
+ }
+ 
+public:
+ 
+ // Specify your inputs as public members here
+ SignalXIn signalXIn;
+ SignalYIn signalYIn;
+ RotationIn rotationIn;
+
+ // Specify your outputs like this
+ Output<Count> signalOut;
+ 
+ // Include a definition for each input in the constructor
+ Rotator(Parameters &p,
+         SignalXIn _signalXIn,
+         SignalYIn _signalYIn,
+         RotationIn _rotationIn) :
+ signalXIn(_signalXIn),
+ signalYIn(_signalYIn),
+ rotationIn(_rotationIn),
+ signalOut(p)
+ {}
+ 
+ // When enabled, channel 0 of the rotation input rotates the mid signal and channel 1
+ // rotates the side signal. Only available for stereo signals.
+ void setMidSide(bool enabled)
+ {
+  midSide = enabled;
+ }
+ 
+ bool isMidSide() const
+ {
+  return midSide;
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  signalOut.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+// int startProcess(int startPoint, int sampleCount)
+// { return std::min(sampleCount, StepSize); }
+
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  // The rotation angle is read per sample but only sampled every ControlInterval
+  // samples. In between, the angle is interpolated linearly.
+  for (int i = startPoint, s = sampleCount; s > 0;)
+  {
+   const int n = std::min(s, ControlInterval);
+   std::array<SampleType, Count> cc;
+   std::array<SampleType, Count> cs;
+   std::array<SampleType, Count> dc;
+   std::array<SampleType, Count> ds;
+   bool constant = true;
+   for (int c = 0; c < Count; ++c)
+   {
+    const SampleType a0 = rotationIn(c, i);
+    const SampleType a1 = rotationIn(c, i + n - 1);
+    cc[c] = cos(a0);
+    cs[c] = sin(a0);
+    if (a0 != a1)
+    {
+     const SampleType delta = (a1 - a0)/static_cast<SampleType>(n - 1);
+     dc[c] = cos(delta);
+     ds[c] = sin(delta);
+     constant = false;
+    }
+    else
+    {
+     dc[c] = 1.;
+     ds[c] = 0.;
+    }
+   }
+   
+   if (midSide) rotateMidSide(i, n, cc, cs, dc, ds, constant);
+   else rotate(i, n, cc, cs, dc, ds, constant);
+   
+   i += n;
+   s -= n;
+  }
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+
+
+
+
+
+
+
+
+
+// Searches for the rotation angle that gives the lowest crest factor (peak to RMS ratio)
+// and glides towards it. Every candidate angle is evaluated on every sample from the
+// analytic pair, which is a handful of multiply-adds per candidate laid out so the
+// compiler can vectorise across candidates. The statistics are gathered over two
+// consecutive windows, so the decision is made over a sliding span of between one and
+// two window lengths. The channels are linked so that the stereo image is preserved.
+template <typename SignalXIn, typename SignalYIn, int Candidates = 16>
+class CrestFactorMinimiser : public Component<CrestFactorMinimiser<SignalXIn, SignalYIn, Candidates>>
+{
+ // Private data members here
+ Parameters &param;
+ 
+ // Candidates span half a turn, because rotating by a further half turn only inverts
+ // the polarity and leaves the crest factor unchanged
+ alignas(32) std::array<float, Candidates> candidateCos;
+ alignas(32) std::array<float, Candidates> candidateSin;
+ alignas(32) std::array<float, Candidates> peak;
+ alignas(32) std::array<float, Candidates> energy;
+ std::array<float, Candidates> lastPeak;
+ std::array<float, Candidates> lastEnergy;
+ 
+ SampleType windowTime {0.2};
+ SampleType glideTime {0.5};
+ SampleType hysteresis {1.05};
+ int windowLength {1};
+ int windowCounter {0};
+ int best {Candidates/2};
+ SampleType target {0.};
+ SampleType current {0.};
+ SampleType glideCoefficient {0.};
+ SampleType coefficientSampleRate {0.};
+ 
+ static SampleType candidateAngle(int k)
+ {
+  return M_PI*(static_cast<SampleType>(k)/static_cast<SampleType>(Candidates) - 0.5);
+ }
+ 
+ void clearWindow()
+ {
+  peak.fill(0.f);
+  energy.fill(0.f);
+  windowCounter = 0;
+ }
+ 
+ void chooseCandidate()
+ {
+  SampleType currentCrest = 0.;
+  SampleType bestCrest = 0.;
+  int choice = -1;
+  for (int k = 0; k < Candidates; ++k)
+  {
+   const SampleType e = energy[k] + lastEnergy[k];
+   // Too quiet to judge, so hold the current angle
+   if (e <= 1e-9) return;
+   // Comparing peak squared over energy is equivalent to comparing crest factors
+   const SampleType p = std::max(peak[k], lastPeak[k]);
+   const SampleType crest = p*p/e;
+   if (k == best) currentCrest = crest;
+   if (choice < 0 || crest < bestCrest)
+   {
+    bestCrest = crest;
+    choice = k;
+   }
+  }
+  // Only move when the improvement is worth having, so the angle doesn't hunt
+  if (bestCrest*hysteresis < currentCrest)
+  {
+   // Every whole number of half turns away gives the same crest factor, so glide to
+   // whichever of those angles is nearest rather than the long way round
+   best = choice;
+   const SampleType a = candidateAngle(best);
+   target = a + M_PI*std::round((current - a)/M_PI);
+  }
+ }
+ 
+public:
+ static constexpr int Count = SignalXIn::Count;
+ 
+ // Specify your inputs as public members here
+ SignalXIn signalXIn;
+ SignalYIn signalYIn;
+ 
+ // Specify your outputs like this
+ Output<Count> angleOut;
+ 
+ // Include a definition for each input in the constructor
+ CrestFactorMinimiser(Parameters &p,
+                      SignalXIn _signalXIn,
+                      SignalYIn _signalYIn) :
+ param(p),
+ signalXIn(_signalXIn),
+ signalYIn(_signalYIn),
+ angleOut(p)
+ {
+  for (int k = 0; k < Candidates; ++k)
+  {
+   candidateCos[k] = cos(candidateAngle(k));
+   candidateSin[k] = sin(candidateAngle(k));
+  }
+  reset();
+ }
+ 
+ // Sets the length of one analysis window in seconds
+ void setWindowTime(SampleType seconds)
+ {
+  windowTime = seconds;
+  coefficientSampleRate = 0.;
+ }
+ 
+ // Sets the time constant of the glide towards a newly chosen angle in seconds
+ void setGlideTime(SampleType seconds)
+ {
+  glideTime = seconds;
+  coefficientSampleRate = 0.;
+ }
+ 
+ // Start the search from a known angle, such as the manual rotation
+ void startFrom(SampleType angle)
+ {
+  current = angle;
+  target = angle;
+  // The candidate equivalent to the angle, allowing for whole half turns
+  best = static_cast<int>(std::round((angle/M_PI + 0.5)*Candidates)) % Candidates;
+  if (best < 0) best += Candidates;
+ }
+ 
+ SampleType getTargetAngle() const
+ {
+  return target;
+ }
+ 
+ SampleType getCurrentAngle() const
+ {
+  return current;
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  clearWindow();
+  lastPeak.fill(0.f);
+  lastEnergy.fill(0.f);
+  angleOut.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+ int startProcess(int startPoint, int sampleCount)
+ {
+  if (coefficientSampleRate != param.sampleRate())
+  {
+   coefficientSampleRate = param.sampleRate();
+   windowLength = std::max(1, static_cast<int>(windowTime*coefficientSampleRate));
+   glideCoefficient = 1. - exp(-1./(glideTime*coefficientSampleRate));
+  }
+  return sampleCount;
+ }
+
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  for (int i = startPoint, s = sampleCount; s--; ++i)
+  {
+   for (int c = 0; c < Count; ++c)
+   {
+    const float x = signalXIn(c, i);
+    const float y = signalYIn(c, i);
+    for (int k = 0; k < Candidates; ++k)
+    {
+     const float v = candidateCos[k]*x + candidateSin[k]*y;
+     peak[k] = std::max(peak[k], std::fabs(v));
+     energy[k] += v*v;
+    }
+   }
+   
+   if (++windowCounter >= windowLength)
+   {
+    chooseCandidate();
+    lastPeak = peak;
+    lastEnergy = energy;
+    clearWindow();
+   }
+   
+   current += glideCoefficient*(target - current);
+   for (int c = 0; c < Count; ++c) angleOut.buffer(c, i) = current;
+  }
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+// Adds an audio rate modulation to a rotation angle. The modulation source is either an
+// LFO, which can be locked to the host tempo, or an envelope follower on a key signal.
+// The source is evaluated once every ControlInterval samples and the result is ramped
+// linearly across the interval, so the per-sample cost is one add.
+template <typename AngleIn, typename KeyIn, int ControlInterval = 32>
+class RotationModulator : public Component<RotationModulator<AngleIn, KeyIn, ControlInterval>>
+{
+ // Private data members here
+ Parameters &param;
+ 
+ int source {0};
+ SampleType depth {0.};
+ SampleType rate {1.};
+ SampleType phase {0.};
+ SampleType attackTime {0.01};
+ SampleType releaseTime {0.15};
+ SampleType attackCoefficient {0.};
+ SampleType releaseCoefficient {0.};
+ SampleType coefficientSampleRate {0.};
+ 
+ SampleType envelope {0.};
+ SampleType keyPeak {0.};
+ SampleType offset {0.};
+ SampleType offsetStep {0.};
+ int controlCounter {0};
+ 
+ // When locked to the transport, the LFO phase at the last sync position and the
+ // number of samples processed since then
+ bool synced {false};
+ SampleType syncPhase {0.};
+ SampleType syncElapsed {0.};
+ 
+ SampleType nextOffset()
+ {
+  const SampleType controlTime = ControlInterval/param.sampleRate();
+  switch (source)
+  {
+   case LFO:
+    // A synced LFO works out its phase at the end of each control interval from the
+    // sync position, so it stays on the beat however the control intervals fall
+    // against the host blocks
+    if (synced) phase = syncPhase + rate*(syncElapsed + ControlInterval)/param.sampleRate();
+    else phase += rate*controlTime;
+    phase -= floor(phase);
+    return depth*sin(2.*M_PI*phase);
+    
+   case Envelope:
+    envelope += ((keyPeak > envelope) ? attackCoefficient : releaseCoefficient)*(keyPeak - envelope);
+    keyPeak = 0.;
+    return depth*std::min(envelope, static_cast<SampleType>(1.));
+    
+   case Off:
+   default:
+    return 0.;
+  }
+ }
+ 
+public:
+ static constexpr int Count = AngleIn::Count;
+ 
+ enum Sources
+ {
+  Off = 0,
+  LFO,
+  Envelope
+ };
+ 
+ // Specify your inputs as public members here
+ AngleIn angleIn;
+ KeyIn keyIn;
+ 
+ // Specify your outputs like this
+ Output<Count> angleOut;
+ 
+ // Include a definition for each input in the constructor
+ RotationModulator(Parameters &p,
+                   AngleIn _angleIn,
+                   KeyIn _keyIn) :
+ param(p),
+ angleIn(_angleIn),
+ keyIn(_keyIn),
+ angleOut(p)
+ {}
+ 
+ void setSource(int newSource)
+ {
+  source = newSource;
+ }
+ 
+ int getSource() const
+ {
+  return source;
+ }
+ 
+ // Sets the peak modulation depth in radians
+ void setDepth(SampleType radians)
+ {
+  depth = radians;
+ }
+ 
+ // Sets the LFO rate in Hz, and lets the LFO run free of the host transport
+ void setRate(SampleType hz)
+ {
+  rate = hz;
+  synced = false;
+ }
+ 
+ // Locks the LFO to the host transport, given the position of the next sample to be
+ // processed. The LFO completes one cycle every beatsPerCycle beats, with phase zero
+ // on every multiple of beatsPerCycle.
+ void setSyncPosition(SampleType ppqPosition, SampleType bpm, SampleType beatsPerCycle)
+ {
+  rate = bpm/(60.*beatsPerCycle);
+  syncPhase = ppqPosition/beatsPerCycle;
+  syncPhase -= floor(syncPhase);
+  syncElapsed = 0.;
+  synced = true;
+ }
+ 
+ // Sets the envelope follower attack and release times in seconds
+ void setEnvelopeTimes(SampleType attack, SampleType release)
+ {
+  attackTime = attack;
+  releaseTime = release;
+  coefficientSampleRate = 0.;
+ }
+ 
+ // Returns the current modulation offset in radians
+ SampleType getOffset() const
+ {
+  return offset;
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  envelope = 0.;
+  keyPeak = 0.;
+  offset = 0.;
+  offsetStep = 0.;
+  controlCounter = 0;
+  angleOut.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+ int startProcess(int startPoint, int sampleCount)
+ {
+  if (coefficientSampleRate != param.sampleRate())
+  {
+   coefficientSampleRate = param.sampleRate();
+   const SampleType controlRate = coefficientSampleRate/ControlInterval;
+   attackCoefficient = 1. - exp(-1./(attackTime*controlRate));
+   releaseCoefficient = 1. - exp(-1./(releaseTime*controlRate));
+  }
+  return sampleCount;
+ }
+
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  for (int i = startPoint, s = sampleCount; s > 0;)
+  {
+   if (controlCounter == 0)
+   {
+    offsetStep = (nextOffset() - offset)/ControlInterval;
+    controlCounter = ControlInterval;
+   }
+   const int n = std::min(s, controlCounter);
+   
+   if (source == Envelope)
+   {
+    for (int c = 0; c < Count; ++c)
+    {
+     for (int j = i, k = n; k--; ++j)
+     {
+      keyPeak = std::max(keyPeak, static_cast<SampleType>(fabs(keyIn(c, j))));
+     }
+    }
+   }
+   
+   for (int c = 0; c < Count; ++c)
+   {
+    SampleType o = offset;
+    for (int j = i, k = n; k--; ++j)
+    {
+     o += offsetStep;
+     angleOut.buffer(c, j) = angleIn(c, j) + o;
+    }
+   }
+   
+   offset += offsetStep*n;
+   controlCounter -= n;
+   syncElapsed += n;
+   i += n;
+   s -= n;
+  }
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+// Derives the amplitude envelope, instantaneous phase and instantaneous frequency from
+// an analytic pair. The phase is scaled to +/-1 for +/-pi, and the frequency to +/-1 for
+// +/- the Nyquist frequency, so that every output is a well behaved audio signal. The
+// frequency is the phase advance from the previous sample, which needs no unwrapping.
+// The quadrature leads the in phase signal, so the analytic signal is x - iy.
+// The per sample outputs are only computed when setOutputs(true) has been called; the
+// meters are always kept, once per step, and can be read from any thread.
+template <typename SignalXIn, typename SignalYIn>
+class AnalyticSignalAnalyser : public Component<AnalyticSignalAnalyser<SignalXIn, SignalYIn>>
+{
+ // Private data members here
+ Parameters &param;
+ 
+public:
+ static constexpr int Count = SignalXIn::Count;
+ static constexpr int StepSize = 128;
+ 
+private:
+ std::array<SampleType, Count> lastX;
+ std::array<SampleType, Count> lastY;
+ bool outputs {false};
+ 
+ // The sum of z[n] times the conjugate of z[n - 1], decaying over MeterTime. Its angle
+ // is the power weighted mean phase advance, so quiet noise doesn't drag it around.
+ static constexpr SampleType MeterTime = 0.3;
+ SampleType correlationX {0.};
+ SampleType correlationY {0.};
+ 
+ std::atomic<float> meanFrequency {0.f};
+ std::array<std::atomic<float>, Count> envelopePeak;
+ 
+public:
+ // Specify your inputs as public members here
+ SignalXIn signalXIn;
+ SignalYIn signalYIn;
+ 
+ // Specify your outputs like this
+ Output<Count> envelopeOut;
+ Output<Count> phaseOut;
+ Output<Count> frequencyOut;
+ 
+ // Include a definition for each input in the constructor
+ AnalyticSignalAnalyser(Parameters &p,
+                        SignalXIn _signalXIn,
+                        SignalYIn _signalYIn) :
+ param(p),
+ signalXIn(_signalXIn),
+ signalYIn(_signalYIn),
+ envelopeOut(p),
+ phaseOut(p),
+ frequencyOut(p)
+ {
+  reset();
+ }
+ 
+ void setOutputs(bool enabled)
+ {
+  outputs = enabled;
+ }
+ 
+ bool hasOutputs() const
+ {
+  return outputs;
+ }
+ 
+ // Returns the mean instantaneous frequency in Hz over about the last MeterTime seconds
+ SampleType getMeanFrequency() const
+ {
+  return meanFrequency.load(std::memory_order_relaxed);
+ }
+ 
+ // Returns the peak envelope of a channel since the last call, and starts a new peak
+ SampleType takeEnvelopePeak(int channel)
+ {
+  return envelopePeak[channel].exchange(0.f, std::memory_order_relaxed);
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  lastX.fill(0.);
+  lastY.fill(0.);
+  correlationX = 0.;
+  correlationY = 0.;
+  meanFrequency.store(0.f, std::memory_order_relaxed);
+  for (auto &e : envelopePeak) e.store(0.f, std::memory_order_relaxed);
+  envelopeOut.reset();
+  phaseOut.reset();
+  frequencyOut.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+ int startProcess(int startPoint, int sampleCount)
+ { return std::min(sampleCount, StepSize); }
+
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  const SampleType decay = exp(-sampleCount/(MeterTime*param.sampleRate()));
+  correlationX *= decay;
+  correlationY *= decay;
+  for (int c = 0; c < Count; ++c)
+  {
+   SampleType px = lastX[c];
+   SampleType py = lastY[c];
+   SampleType peak = 0.;
+   SampleType re = 0.;
+   SampleType im = 0.;
+   if (outputs)
+   {
+    for (int i = startPoint, s = sampleCount; s--; ++i)
+    {
+     const SampleType x = signalXIn(c, i);
+     const SampleType y = signalYIn(c, i);
+     const SampleType power = x*x + y*y;
+     // z[n] times the conjugate of z[n - 1]
+     const SampleType r = x*px + y*py;
+     const SampleType j = x*py - y*px;
+     envelopeOut.buffer(c, i) = sqrt(power);
+     phaseOut.buffer(c, i) = atan2(-y, x)/M_PI;
+     frequencyOut.buffer(c, i) = atan2(j, r)/M_PI;
+     peak = std::max(peak, power);
+     re += r;
+     im += j;
+     px = x;
+     py = y;
+    }
+   }
+   else
+   {
+    // Only the meters, which need no per sample trigonometry
+    for (int i = startPoint, s = sampleCount; s--; ++i)
+    {
+     const SampleType x = signalXIn(c, i);
+     const SampleType y = signalYIn(c, i);
+     peak = std::max(peak, x*x + y*y);
+     re += x*px + y*py;
+     im += x*py - y*px;
+     px = x;
+     py = y;
+    }
+   }
+   lastX[c] = px;
+   lastY[c] = py;
+   correlationX += re;
+   correlationY += im;
+   
+   const float envelope = static_cast<float>(sqrt(peak));
+   float previous = envelopePeak[c].load(std::memory_order_relaxed);
+   while (envelope > previous
+          && !envelopePeak[c].compare_exchange_weak(previous, envelope, std::memory_order_relaxed));
+  }
+  const SampleType frequency = (correlationX != 0. || correlationY != 0.)
+  ? 0.5*param.sampleRate()*atan2(correlationY, correlationX)/M_PI : 0.;
+  meanFrequency.store(static_cast<float>(frequency), std::memory_order_relaxed);
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+// Delays a signal by a whole number of samples, up to MaximumDelay. Used to pad the
+// latency of the cheaper modes up to a longer latency that has been reported to the host.
+// The buffer isn't allocated until allocate() is called, and until then the signal
+// passes straight through.
+template <typename SignalIn, int MaximumDelay>
+class LatencyDelay : public Component<LatencyDelay<SignalIn, MaximumDelay>>
+{
+ // Private data members here
+ static constexpr int BufferSize = []()
+ {
+  int size = 1;
+  while (size <= MaximumDelay) size <<= 1;
+  return size;
+ }();
+ static constexpr int Mask = BufferSize - 1;
+ 
+ std::vector<SampleType> buffer;
+ std::atomic<bool> allocated {false};
+ int writePosition {0};
+ int delay {0};
+ 
+public:
+ static constexpr int Count = SignalIn::Count;
+ 
+ // Specify your inputs as public members here
+ SignalIn signalIn;
+ 
+ // Specify your outputs like this
+ Output<Count> signalOut;
+ 
+ // Include a definition for each input in the constructor
+ LatencyDelay(Parameters &p, SignalIn _signalIn) :
+ signalIn(_signalIn),
+ signalOut(p)
+ {}
+ 
+ // Allocates the buffer. Call this off the audio thread; it is safe to call while the
+ // audio thread is processing.
+ void allocate()
+ {
+  if (allocated.load(std::memory_order_acquire)) return;
+  buffer.assign(Count*BufferSize, 0.);
+  allocated.store(true, std::memory_order_release);
+ }
+ 
+ bool isAllocated() const
+ {
+  return allocated.load(std::memory_order_acquire);
+ }
+ 
+ void setDelay(int samples)
+ {
+  delay = std::max(0, std::min(MaximumDelay, samples));
+ }
+ 
+ int getDelay() const
+ {
+  return delay;
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  if (isAllocated()) std::fill(buffer.begin(), buffer.end(), 0.);
+  signalOut.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+// int startProcess(int startPoint, int sampleCount)
+// { return std::min(sampleCount, StepSize); }
+
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  const bool delaying = delay > 0 && isAllocated();
+  for (int c = 0; c < Count; ++c)
+  {
+   if (!delaying)
+   {
+    for (int i = startPoint, s = sampleCount; s--; ++i) signalOut.buffer(c, i) = signalIn(c, i);
+   }
+   else
+   {
+    SampleType *b = buffer.data() + c*BufferSize;
+    for (int i = startPoint, s = sampleCount, w = writePosition; s--; ++i, ++w)
+    {
+     b[w & Mask] = signalIn(c, i);
+     signalOut.buffer(c, i) = b[(w - delay) & Mask];
+    }
+   }
+  }
+  writePosition = (writePosition + sampleCount) & Mask;
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+// Fades between a processed signal and an unprocessed one. The two are delay aligned
+// and strongly correlated, so the gains always sum to one, following a raised cosine
+// curve. Used to engage and disengage the bypass without clicks.
+template <typename WetIn, typename DryIn>
+class BypassCrossfade : public Component<BypassCrossfade<WetIn, DryIn>>
+{
+ // Private data members here
+ Parameters &param;
+ SampleType position {1.};
+ SampleType target {1.};
+ SampleType fadeTime {0.02};
+ 
+public:
+ static constexpr int Count = WetIn::Count;
+ 
+ // Specify your inputs as public members here
+ WetIn wetIn;
+ DryIn dryIn;
+ 
+ // Specify your outputs like this
+ Output<Count> signalOut;
+ 
+ // Include a definition for each input in the constructor
+ BypassCrossfade(Parameters &p, WetIn _wetIn, DryIn _dryIn) :
+ param(p),
+ wetIn(_wetIn),
+ dryIn(_dryIn),
+ signalOut(p)
+ {}
+ 
+ // Sets the length of a complete fade in seconds
+ void setFadeTime(SampleType seconds)
+ {
+  fadeTime = seconds;
+ }
+ 
+ void setTarget(bool wet)
+ {
+  target = wet ? 1. : 0.;
+ }
+ 
+ // Jump straight to the target without fading
+ void snap()
+ {
+  position = target;
+ }
+ 
+ bool isWet() const
+ {
+  return position == 1.;
+ }
+ 
+ bool isDry() const
+ {
+  return position == 0.;
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  position = target;
+  signalOut.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+// int startProcess(int startPoint, int sampleCount)
+// { return std::min(sampleCount, StepSize); }
+
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  if (position == target)
+  {
+   // Settled, so only one side is read
+   for (int c = 0; c < Count; ++c)
+   {
+    if (position == 1.)
+    {
+     for (int i = startPoint, s = sampleCount; s--; ++i) signalOut.buffer(c, i) = wetIn(c, i);
+    }
+    else
+    {
+     for (int i = startPoint, s = sampleCount; s--; ++i) signalOut.buffer(c, i) = dryIn(c, i);
+    }
+   }
+   return;
+  }
+  
+  const SampleType step = (target > position ? 1. : -1.)/std::max(SampleType(1.), fadeTime*param.sampleRate());
+  SampleType x = position;
+  for (int i = startPoint, s = sampleCount; s--; ++i)
+  {
+   x = std::max(SampleType(0.), std::min(SampleType(1.), x + step));
+   const SampleType wet = 0.5 - 0.5*cos(M_PI*x);
+   const SampleType dry = 1. - wet;
+   for (int c = 0; c < Count; ++c)
+   {
+    signalOut.buffer(c, i) = wet*wetIn(c, i) + dry*dryIn(c, i);
+   }
+  }
+  position = x;
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+class PhaseRotatorDSP : public Component<PhaseRotatorDSP>
+{
+ // Private data members here
+ int modeLatency {0};
+ int compensationDelay {0};
+ bool bypassed {false};
+ bool wetIdle {false};
+ int warmUp {0};
+ bool primeHighQuality {false};
+ 
+ // Extra samples run through the filters before fading back in from bypass, to let
+ // the IIR filters settle
+ static constexpr int WarmUpMargin = 512;
+ 
+ void updateBypassDelay()
+ {
+  bypassDelay.setDelay(modeLatency + compensationDelay);
+ }
+ 
+ void resetWet()
+ {
+  hil.reset();
+  f255.reset();
+  f1023.reset();
+  f2047.reset();
+  fVariable.reset();
+  f4095.reset();
+  peakReducer.reset();
+  modulator.reset();
+  rotator.reset();
+  compensation.reset();
+  inPhaseCompensation.reset();
+  quadratureCompensation.reset();
+  analytic.reset();
+ }
+ 
+public:
+ static constexpr int Count = 2;
+ 
+ // Specify your inputs as public members here
+ BufferCoupler<float, 2> floatInput;
+ BufferCoupler<float, 2> keyInput;
+ 
+ SignalProbe<Connector<2>> inputProbe;
+ 
+ IIRHilbertApproximator<Connector<2>> hil;
+ ConvolutionHilbertFilter<Connector<2>, 255> f255;
+ ConvolutionHilbertFilter<Connector<2>, 1023> f1023;
+ ConvolutionHilbertFilter<Connector<2>, 2047> f2047;
+ 
+ // The variable and offline modes use this repository's own Blackman windowed
+ // kernels. They differ slightly in sound from XDDSP's filters used by the fixed
+ // length modes; the regression tests measure by how much.
+ 
+ // Its length follows the lowest frequency that has to be rotated accurately
+ VariableHilbertFilter<Connector<2>, 4095> fVariable;
+ static constexpr int VariableMode = 4;
+ 
+ // Only used for offline rendering, where accuracy matters more than speed. It isn't
+ // allocated until allocateHighQuality() is called.
+ FIRHilbertFilter<Connector<2>, 4095> f4095;
+ static constexpr int HighQualityMode = 5;
+
+ typedef OutputSwitch<6, 2> RotatorInputSwitch;
+ typedef Switch<2, 2> RotationSourceSwitch;
+ typedef RotationModulator<RotationSourceSwitch, Connector<2>> Modulator;
+ 
+ ControlGlide<2> manualRotation;
+ CrestFactorMinimiser<RotatorInputSwitch, RotatorInputSwitch> peakReducer;
+ Modulator modulator;
+ 
+ Rotator<RotatorInputSwitch, RotatorInputSwitch, Connector<2>> rotator;
+ 
+ LatencyDelay<Connector<2>, 2047> compensation;
+ 
+ // The analytic pair is delayed by the same compensation as the output, so the side
+ // outputs line up with the main output. Like the output's, these delays are only
+ // needed, and only allocated, with high quality rendering.
+ LatencyDelay<RotatorInputSwitch, 2047> inPhaseCompensation;
+ LatencyDelay<RotatorInputSwitch, 2047> quadratureCompensation;
+ AnalyticSignalAnalyser<Connector<2>, Connector<2>> analytic;
+ 
+ // The bypass path delays the input by the reported latency, so bypassing doesn't
+ // move the track in time
+ LatencyDelay<Connector<2>, 2047> bypassDelay;
+ BypassCrossfade<Connector<2>, Connector<2>> bypassFade;
+ 
+ SignalProbe<Connector<2>> outputProbe;
+ 
+ RotatorInputSwitch inPhaseSwitch()
+ { return {{&hil.inPhaseOut, &f255.inPhaseOut, &f1023.inPhaseOut, &f2047.inPhaseOut, &fVariable.inPhaseOut, &f4095.inPhaseOut}}; }
+ 
+ RotatorInputSwitch quadratureSwitch()
+ { return {{&hil.quadratureOut, &f255.quadratureOut, &f1023.quadratureOut, &f2047.quadratureOut, &fVariable.quadratureOut, &f4095.quadratureOut}}; }
+ 
+ // Include a definition for each input in the constructor
+ PhaseRotatorDSP(Parameters &p) :
+ inputProbe(p, floatInput),
+ hil(p, floatInput),
+ f255(p, floatInput),
+ f1023(p, floatInput),
+ f2047(p, floatInput),
+ fVariable(p, floatInput),
+ f4095(p, floatInput),
+ manualRotation(p),
+ peakReducer(p, inPhaseSwitch(), quadratureSwitch()),
+ modulator(p, {{&manualRotation.controlOut, &peakReducer.angleOut}}, keyInput),
+ rotator(p,
+         inPhaseSwitch(),
+         quadratureSwitch(),
+         modulator.angleOut),
+ compensation(p, rotator.signalOut),
+ inPhaseCompensation(p, inPhaseSwitch()),
+ quadratureCompensation(p, quadratureSwitch()),
+ analytic(p, inPhaseCompensation.signalOut, quadratureCompensation.signalOut),
+ bypassDelay(p, floatInput),
+ bypassFade(p, compensation.signalOut, bypassDelay.signalOut),
+ outputProbe(p, bypassFade.signalOut)
+ {
+  bypassDelay.allocate();
+  manualRotation.setPeriod(2.*M_PI);
+  peakReducer.setEnabled(false);
+  setAnalysis(false, false);
+  setMode(0);
+ }
+ 
+ // The high quality filter and the compensation delays that pad the other modes to
+ // its latency are only needed once high quality rendering is turned on, so they are
+ // only allocated then. Call this off the audio thread; it is safe to call while the
+ // audio thread is processing, and does nothing the second time.
+ void allocateHighQuality()
+ {
+  compensation.allocate();
+  inPhaseCompensation.allocate();
+  quadratureCompensation.allocate();
+  f4095.allocate();
+ }
+ 
+ bool isHighQualityAllocated() const
+ {
+  return compensation.isAllocated() && inPhaseCompensation.isAllocated()
+  && quadratureCompensation.isAllocated() && f4095.isAllocated();
+ }
+ 
+ // While another mode is in use, keeps the high quality filter's history filled, so
+ // that an offline render starts with it ready rather than empty
+ void setHighQualityPrimed(bool enabled)
+ {
+  primeHighQuality = enabled;
+ }
+ 
+ // Delays the output, and the analytic side outputs, by this many samples
+ void setCompensationDelay(int samples)
+ {
+  compensationDelay = samples;
+  compensation.setDelay(samples);
+  inPhaseCompensation.setDelay(samples);
+  quadratureCompensation.setDelay(samples);
+  updateBypassDelay();
+ }
+ 
+ // While bypassed and faded out, only the bypass delay runs. Coming out of bypass,
+ // the filters are run until they have settled before fading back in.
+ void setBypass(bool enabled)
+ {
+  if (enabled == bypassed) return;
+  bypassed = enabled;
+  if (bypassed)
+  {
+   warmUp = 0;
+   bypassFade.setTarget(false);
+  }
+  else if (wetIdle)
+  {
+   wetIdle = false;
+   const int filterLatency = primeHighQuality ? f4095.DelayLength : modeLatency;
+   warmUp = 2*filterLatency + 1 + compensationDelay + WarmUpMargin;
+  }
+  else
+  {
+   bypassFade.setTarget(true);
+  }
+ }
+ 
+ bool isBypassed() const
+ {
+  return bypassed;
+ }
+ 
+ // Jump straight to the current bypass state without fading
+ void snapBypass()
+ {
+  warmUp = 0;
+  bypassFade.setTarget(!bypassed);
+  bypassFade.snap();
+ }
+ 
+ // The analytic meters are cheap, but are still only kept when asked for. The
+ // envelope, phase and frequency outputs cost a square root and two arctangents per
+ // sample, so they are computed separately, only when outputs is true.
+ void setAnalysis(bool meters, bool outputs)
+ {
+  const bool enabled = meters || outputs;
+  inPhaseCompensation.setEnabled(enabled);
+  quadratureCompensation.setEnabled(enabled);
+  analytic.setEnabled(enabled);
+  analytic.setOutputs(outputs);
+ }
+ 
+ // Returns the latency of the Hilbert filter used by a mode
+ int getModeLatency(int mode) const
+ {
+  switch (mode)
+  {
+   case 0:
+   default:
+    return 0;
+    
+   case 1:
+    return f255.DelayLength;
+    
+   case 2:
+    return f1023.DelayLength;
+    
+   case 3:
+    return f2047.DelayLength;
+    
+   case VariableMode:
+    return fVariable.getDelayLength();
+    
+   case HighQualityMode:
+    return f4095.DelayLength;
+  }
+ }
+ 
+ void setMode(int mode)
+ {
+  modeLatency = getModeLatency(mode);
+  updateBypassDelay();
+  hil.setEnabled(mode == 0);
+  f255.setEnabled(mode == 1);
+  f1023.setEnabled(mode == 2);
+  f2047.setEnabled(mode == 3);
+  fVariable.setEnabled(mode == VariableMode);
+  f4095.setEnabled(mode == HighQualityMode);
+  peakReducer.signalXIn.select(mode);
+  peakReducer.signalYIn.select(mode);
+  rotator.signalXIn.select(mode);
+  rotator.signalYIn.select(mode);
+  inPhaseCompensation.signalIn.select(mode);
+  quadratureCompensation.signalIn.select(mode);
+ }
+ 
+ // In peak reduction mode the rotation is chosen automatically to minimise the crest
+ // factor, starting from the manual rotation
+ void setPeakReduction(bool enabled)
+ {
+  if (enabled && !peakReducer.isEnabled())
+  {
+   peakReducer.startFrom(manualRotation.getControl(0));
+  }
+  else if (!enabled && peakReducer.isEnabled())
+  {
+   // Glide back to the manual rotation from wherever the automatic angle got to
+   const SampleType a = peakReducer.getCurrentAngle();
+   for (int c = 0; c < 2; ++c) manualRotation.startFrom(c, a);
+  }
+  peakReducer.setEnabled(enabled);
+  modulator.angleIn.select(enabled ? 1 : 0);
+ }
+ 
+ // This function is responsible for clearing the output buffers to a default state when
+ // the component is disabled.
+ void reset()
+ {
+  inputProbe.reset();
+  hil.reset();
+  f255.reset();
+  f1023.reset();
+  f2047.reset();
+  fVariable.reset();
+  f4095.reset();
+  manualRotation.reset();
+  peakReducer.reset();
+  modulator.reset();
+  rotator.reset();
+  compensation.reset();
+  inPhaseCompensation.reset();
+  quadratureCompensation.reset();
+  analytic.reset();
+  bypassDelay.reset();
+  bypassFade.reset();
+  outputProbe.reset();
+ }
+ 
+ // startProcess prepares the component for processing one block and returns the step
+ // size. By default, it returns the entire sampleCount as one big step.
+// int startProcess(int startPoint, int sampleCount)
+// { return std::min(sampleCount, StepSize); }
+
+ // stepProcess is called repeatedly with the start point incremented by step size
+ void stepProcess(int startPoint, int sampleCount)
+ {
+  // Once the fade into bypass has finished, the filters are cleared and left idle
+  if (bypassed && !wetIdle && bypassFade.isDry())
+  {
+   resetWet();
+   wetIdle = true;
+  }
+  
+  inputProbe.process(startPoint, sampleCount);
+  manualRotation.process(startPoint, sampleCount);
+  if (!wetIdle)
+  {
+   hil.process(startPoint, sampleCount);
+   f255.process(startPoint, sampleCount);
+   f1023.process(startPoint, sampleCount);
+   f2047.process(startPoint, sampleCount);
+   fVariable.process(startPoint, sampleCount);
+   f4095.process(startPoint, sampleCount);
+   if (primeHighQuality && !f4095.isEnabled()) f4095.prime(startPoint, sampleCount);
+   peakReducer.process(startPoint, sampleCount);
+   modulator.process(startPoint, sampleCount);
+   rotator.process(startPoint, sampleCount);
+   compensation.process(startPoint, sampleCount);
+   inPhaseCompensation.process(startPoint, sampleCount);
+   quadratureCompensation.process(startPoint, sampleCount);
+   analytic.process(startPoint, sampleCount);
+  }
+  bypassDelay.process(startPoint, sampleCount);
+  bypassFade.process(startPoint, sampleCount);
+  outputProbe.process(startPoint, sampleCount);
+  
+  if (warmUp > 0)
+  {
+   warmUp -= sampleCount;
+   if (warmUp <= 0) bypassFade.setTarget(true);
+  }
+ }
+ 
+ // finishProcess is called after the block has been processed
+// void finishProcess()
+// {}
+};
+
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+ 
+}
@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    HilbertKernels.h
+    Created: 19 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+
+
+
+
+
+
+
+
+
+
+namespace XDDSP
+{
+
+
+
+
+
+
+
+
+
+
+enum class HilbertWindow
+{
+ Hann,
+ Blackman,
+ BlackmanHarris
+};
+
+
+
+
+
+
+
+
+
+
+// A windowed FIR Hilbert transformer of odd length N has its centre at M = (N - 1)/2
+// and is zero at every even offset from the centre, so only the odd offsets are
+// stored. Those samples of the input all fall on the same parity of time, so the filter
+// keeps its history split by parity and runs the kernel as one contiguous dot product.
+//
+// The weights are laid out from the oldest input sample to the newest: offsets
+// +nmax, +nmax - 2, ..., +1, -1, ..., -nmax, where nmax is the largest odd number no
+// greater than M. The weight at offset n is -2 w(n)/(pi n). That is the negative of the
+// textbook transformer, so the quadrature output leads the in phase output by a
+// quarter turn, the same way round as XDDSP's Hilbert filters.
+namespace HilbertKernelDetail
+{
+ constexpr double pi = 3.14159265358979323846;
+ 
+ // Taylor series, only ever called with small arguments
+ constexpr double cosine(double x)
+ {
+  double term = 1.;
+  double sum = 1.;
+  for (int k = 1; k < 20; ++k)
+  {
+   term *= -x*x/((2*k - 1)*(2*k));
+   sum += term;
+  }
+  return sum;
+ }
+ 
+ constexpr int tapCount(int length)
+ {
+  const int m = (length - 1)/2;
+  return (m % 2) ? m + 1 : m;
+ }
+ 
+ // The window evaluated at offset n from the centre, given c = cos(pi n/M)
+ constexpr double window(HilbertWindow w, double c)
+ {
+  switch (w)
+  {
+   case HilbertWindow::Hann:
+    return 0.5 + 0.5*c;
+    
+   case HilbertWindow::Blackman:
+    return 0.42 + 0.5*c + 0.08*(2.*c*c - 1.);
+    
+   case HilbertWindow::BlackmanHarris:
+   default:
+    return 0.35875 + 0.48829*c + 0.14128*(2.*c*c - 1.) + 0.01168*(4.*c*c*c - 3.*c);
+  }
+ }
+}
+
+
+
+
+
+
+
+
+
+
+// Fills dest with the tapCount(length) weights of a Hilbert transformer. This is usable
+// both at compile time, for the fixed kernels below, and at run time.
+template <typename Sample>
+constexpr void makeHilbertKernel(Sample *dest, int length, HilbertWindow w)
+{
+ using namespace HilbertKernelDetail;
+ 
+ const int m = (length - 1)/2;
+ const int taps = tapCount(length);
+ const int half = taps/2;
+ 
+ // cos(pi n/M) is stepped along with the Chebyshev recurrence, so only one cosine is
+ // ever evaluated directly
+ const double c1 = cosine(pi/m);
+ double previous = 1.;
+ double current = c1;
+ for (int n = 1, j = 0; j < half; ++n)
+ {
+  if (n % 2)
+  {
+   const double weight = 2.*window(w, current)/(pi*n);
+   dest[half - 1 - j] = static_cast<Sample>(-weight);
+   dest[half + j] = static_cast<Sample>(weight);
+   ++j;
+  }
+  const double next = 2.*c1*current - previous;
+  previous = current;
+  current = next;
+ }
+}
+
+
+
+
+
+
+
+
+
+
+// The weights for a fixed length and window, generated at compile time. There is one
+// read-only copy in the program no matter how many filters use it.
+template <int Length, HilbertWindow Window = HilbertWindow::Blackman>
+struct HilbertKernel
+{
+ static_assert(Length % 2 == 1 && Length >= 7, "Hilbert kernels must have an odd length");
+ 
+ static constexpr int DelayLength = (Length - 1)/2;
+ static constexpr int Taps = HilbertKernelDetail::tapCount(Length);
+ 
+ static constexpr std::array<double, Taps> weights = []()
+ {
+  std::array<double, Taps> k {};
+  makeHilbertKernel(k.data(), Length, Window);
+  return k;
+ }();
+};
+
+
+
+
+
+
+
+
+
+
+}
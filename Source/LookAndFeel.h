@@ -189,56 +189,136 @@ class XDLookAndFeel : public juce::LookAndFeel_V4
 
 
 
+// Draws a scrolling min/max envelope with one column per pixel at most. The envelope is
+// kept as a juce::Path which is only rebuilt when new columns arrive or the component
+// changes size, so a repaint with no new data is a single fillPath.
 template <int BufferSize>
 class WaveformDisplay : public juce::Component
 {
- std::array<float, BufferSize> wave;
+ std::array<float, BufferSize> minimum;
+ std::array<float, BufferSize> maximum;
+ int writePosition {0};
+ 
+ juce::Path path;
+ bool pathIsValid {false};
+ 
+ // Merges the columns that share pixel x out of the given number of pixels, in
+ // chronological order
+ void column(int x, int pixels, float &lo, float &hi) const
+ {
+  const int first = x*BufferSize/pixels;
+  const int last = std::max(first + 1, (x + 1)*BufferSize/pixels);
+  lo = 1.f;
+  hi = -1.f;
+  for (int i = first; i < last; ++i)
+  {
+   const int j = (writePosition + i) % BufferSize;
+   lo = std::min(lo, minimum[j]);
+   hi = std::max(hi, maximum[j]);
+  }
+ }
+ 
+ void rebuildPath()
+ {
+  path.clear();
+  pathIsValid = true;
+  
+  const int pixels = std::min(getWidth(), BufferSize);
+  if (pixels <= 0) return;
+  
+  const float xScale = static_cast<float>(getWidth()) / pixels;
+  const float yScale = 0.5*getHeight();
+  const float yMid = 0.5*getHeight();
+  float lo, hi;
+  
+  // Trace the maxima left to right and then the minima back again, keeping the
+  // envelope at least a pixel thick so that silence still draws a line
+  for (int x = 0; x < pixels; ++x)
+  {
+   column(x, pixels, lo, hi);
+   const float y = yMid - juce::jlimit(-1.f, 1.f, hi)*yScale - 0.5f;
+   if (x == 0) path.startNewSubPath(0.f, y);
+   path.lineTo((x + 0.5f)*xScale, y);
+  }
+  path.lineTo(static_cast<float>(getWidth()), path.getCurrentPosition().y);
+  for (int x = pixels; x--;)
+  {
+   column(x, pixels, lo, hi);
+   const float y = yMid - juce::jlimit(-1.f, 1.f, lo)*yScale + 0.5f;
+   if (x == pixels - 1) path.lineTo(static_cast<float>(getWidth()), y);
+   path.lineTo((x + 0.5f)*xScale, y);
+  }
+  path.lineTo(0.f, path.getCurrentPosition().y);
+  path.closeSubPath();
+ }
  
 public:
  juce::Colour waveformColour {juce::Colours::white};
  
  WaveformDisplay()
  {
-  wave.fill(0);
+  clear();
+  setOpaque(true);
+ }
+ 
+ void clear()
+ {
+  minimum.fill(0.);
+  maximum.fill(0.);
+  writePosition = 0;
+  pathIsValid = false;
+  repaint();
  }
  
  template <typename Iterator>
  void changeWave(Iterator start, Iterator end)
  {
-  wave.fill(0.);
+  minimum.fill(0.);
+  maximum.fill(0.);
+  writePosition = 0;
   
   int i = 0;
   for (Iterator it = start; i < BufferSize && it < end; ++i, ++it)
   {
-   wave[i] = *it;
+   minimum[i] = *it;
+   maximum[i] = *it;
   }
   
+  pathIsValid = false;
   repaint();
  }
  
- void paint (juce::Graphics& g) override
+ // Appends columns to the right hand side, scrolling the oldest off the left. The
+ // iterator must point to objects with minimum and maximum members.
+ template <typename Iterator>
+ void pushColumns(Iterator start, Iterator end)
  {
-  float width = getWidth();
+  if (start == end) return;
   
-  float xScale = width / BufferSize;
-  float yScale = 0.5*getHeight();
-  float yMid = 0.5*getHeight();
+  for (Iterator it = start; it != end; ++it)
+  {
+   minimum[writePosition] = it->minimum;
+   maximum[writePosition] = it->maximum;
+   writePosition = (writePosition + 1) % BufferSize;
+  }
   
-  g.setColour(juce::Colours::black);
-  g.fillRect(0, 0, getWidth(), getHeight());
+  pathIsValid = false;
+  repaint();
+ }
+ 
+ void resized() override
+ {
+  pathIsValid = false;
+ }
+ 
+ void paint (juce::Graphics& g) override
+ {
+  g.fillAll(juce::Colours::black);
   
-  float x = 0;
-  float y = yMid - wave[0]*yScale;
+  if (!pathIsValid) rebuildPath();
   
   g.setColour(waveformColour);
-  for (int i = 1; i < BufferSize; ++i)
-  {
-   float x2 = static_cast<float>(i)*xScale;
-   float y2 = yMid - wave[i]*yScale;
-   g.drawLine(x, y, x2, y2);
-   x = x2;
-   y = y2;
-  }
+  g.fillPath(path);
  }
 };
 
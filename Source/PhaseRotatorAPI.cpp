@@ -0,0 +1,249 @@
+/*
+  ==============================================================================
+
+    PhaseRotatorAPI.cpp
+    Created: 19 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "PhaseRotatorAPI.h"
+#include "DSP.h"
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <new>
+#include <vector>
+
+static constexpr int DefaultSubBlockSize = 128;
+static constexpr int MaximumSubBlockSize = 1024;
+static constexpr float DefaultLowFrequency = 80.f;
+
+struct PhaseRotator
+{
+ XDDSP::Parameters param;
+ XDDSP::PhaseRotatorDSP dsp;
+ std::mutex lock;
+
+ int subBlockSize;
+ int mode {PHASEROTATOR_MODE_IIR};
+ int stereoMode {PHASEROTATOR_STEREO_LINKED};
+ float rotation {0.f};
+ float rotation2 {0.f};
+
+ // Scratch channels for mono and interleaved buffers
+ std::vector<float> scratchLeft;
+ std::vector<float> scratchRight;
+
+ PhaseRotator(double sampleRate, int size) :
+ dsp(param),
+ subBlockSize(size),
+ scratchLeft(size),
+ scratchRight(size)
+ {
+  param.setSampleRate(sampleRate);
+  param.setBufferSize(size);
+  dsp.fVariable.setLength(dsp.fVariable.lengthForFrequency(sampleRate, DefaultLowFrequency));
+  dsp.fVariable.updateKernel();
+  dsp.manualRotation.setControl(0.);
+  dsp.manualRotation.snap();
+ }
+ 
+ // As in the plugin, linked mode rotates both channels by the first rotation
+ void updateRotation()
+ {
+  const float second = (stereoMode == PHASEROTATOR_STEREO_LINKED) ? rotation : rotation2;
+  dsp.manualRotation.setControl(0, rotation / 180. * M_PI);
+  dsp.manualRotation.setControl(1, second / 180. * M_PI);
+ }
+
+ // Walks a pair of planar channels in sub-blocks. The engine reads the input where
+ // it lies and writes its output back over it.
+ void processPlanar(float *left, float *right, int sampleCount)
+ {
+  for (int offset = 0; offset < sampleCount; offset += subBlockSize)
+  {
+   const int n = std::min(subBlockSize, sampleCount - offset);
+   if (right == nullptr) std::copy(left + offset, left + offset + n, scratchRight.begin());
+   std::array<float*, 2> io {left + offset, right ? right + offset : scratchRight.data()};
+   dsp.floatInput.connect(io);
+   dsp.keyInput.connect(io);
+   dsp.process(0, n);
+   dsp.bypassFade.signalOut.fastTransfer<float>(io, n);
+  }
+ }
+
+ void processInterleaved(float *samples, int frameCount)
+ {
+  for (int offset = 0; offset < frameCount; offset += subBlockSize)
+  {
+   const int n = std::min(subBlockSize, frameCount - offset);
+   float *frame = samples + 2*offset;
+   for (int i = 0; i < n; ++i)
+   {
+    scratchLeft[i] = frame[2*i];
+    scratchRight[i] = frame[2*i + 1];
+   }
+   processPlanar(scratchLeft.data(), scratchRight.data(), n);
+   for (int i = 0; i < n; ++i)
+   {
+    frame[2*i] = scratchLeft[i];
+    frame[2*i + 1] = scratchRight[i];
+   }
+  }
+ }
+};
+
+
+
+
+
+PhaseRotator* phaserotator_create(double sampleRate, int subBlockSize)
+{
+ if (!(sampleRate > 0.)) return nullptr;
+ if (subBlockSize == 0) subBlockSize = DefaultSubBlockSize;
+ if (subBlockSize < 1 || subBlockSize > MaximumSubBlockSize) return nullptr;
+
+ try
+ {
+  return new PhaseRotator(sampleRate, subBlockSize);
+ }
+ catch (const std::bad_alloc&)
+ {
+  return nullptr;
+ }
+}
+
+void phaserotator_destroy(PhaseRotator *handle)
+{
+ delete handle;
+}
+
+int phaserotator_process(PhaseRotator *handle, float **channels, int channelCount, int sampleCount)
+{
+ if (handle == nullptr || channels == nullptr || sampleCount < 0) return PHASEROTATOR_INVALID_ARGUMENT;
+ if (channelCount < 1 || channelCount > 2) return PHASEROTATOR_INVALID_ARGUMENT;
+ if (channels[0] == nullptr || (channelCount == 2 && channels[1] == nullptr)) return PHASEROTATOR_INVALID_ARGUMENT;
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ handle->processPlanar(channels[0], (channelCount == 2) ? channels[1] : nullptr, sampleCount);
+ return PHASEROTATOR_OK;
+}
+
+int phaserotator_process_interleaved(PhaseRotator *handle, float *samples, int channelCount, int frameCount)
+{
+ if (handle == nullptr || samples == nullptr || frameCount < 0) return PHASEROTATOR_INVALID_ARGUMENT;
+ if (channelCount < 1 || channelCount > 2) return PHASEROTATOR_INVALID_ARGUMENT;
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ if (channelCount == 1) handle->processPlanar(samples, nullptr, frameCount);
+ else handle->processInterleaved(samples, frameCount);
+ return PHASEROTATOR_OK;
+}
+
+int phaserotator_set_rotation(PhaseRotator *handle, float degrees)
+{
+ if (handle == nullptr) return PHASEROTATOR_INVALID_ARGUMENT;
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ handle->rotation = degrees;
+ handle->updateRotation();
+ return PHASEROTATOR_OK;
+}
+
+int phaserotator_set_rotation2(PhaseRotator *handle, float degrees)
+{
+ if (handle == nullptr) return PHASEROTATOR_INVALID_ARGUMENT;
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ handle->rotation2 = degrees;
+ handle->updateRotation();
+ return PHASEROTATOR_OK;
+}
+
+int phaserotator_set_stereo_mode(PhaseRotator *handle, int stereoMode)
+{
+ if (handle == nullptr) return PHASEROTATOR_INVALID_ARGUMENT;
+ if (stereoMode < PHASEROTATOR_STEREO_LINKED || stereoMode > PHASEROTATOR_STEREO_MID_SIDE) return PHASEROTATOR_INVALID_ARGUMENT;
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ handle->stereoMode = stereoMode;
+ handle->dsp.rotator.setMidSide(stereoMode == PHASEROTATOR_STEREO_MID_SIDE);
+ handle->updateRotation();
+ return PHASEROTATOR_OK;
+}
+
+int phaserotator_set_mode(PhaseRotator *handle, int mode)
+{
+ if (handle == nullptr) return PHASEROTATOR_INVALID_ARGUMENT;
+ if (mode < PHASEROTATOR_MODE_IIR || mode > PHASEROTATOR_MODE_HIGH_QUALITY) return PHASEROTATOR_INVALID_ARGUMENT;
+ static_assert(PHASEROTATOR_MODE_FIR_VARIABLE == XDDSP::PhaseRotatorDSP::VariableMode, "Mode numbers must match the engine");
+ static_assert(PHASEROTATOR_MODE_HIGH_QUALITY == XDDSP::PhaseRotatorDSP::HighQualityMode, "Mode numbers must match the engine");
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ if (mode == PHASEROTATOR_MODE_HIGH_QUALITY)
+ {
+  try
+  {
+   handle->dsp.allocateHighQuality();
+  }
+  catch (const std::bad_alloc&)
+  {
+   return PHASEROTATOR_OUT_OF_MEMORY;
+  }
+ }
+ handle->mode = mode;
+ handle->dsp.setMode(mode);
+ return PHASEROTATOR_OK;
+}
+
+int phaserotator_set_low_frequency(PhaseRotator *handle, float hertz)
+{
+ if (handle == nullptr || !(hertz > 0.f)) return PHASEROTATOR_INVALID_ARGUMENT;
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ XDDSP::PhaseRotatorDSP &dsp = handle->dsp;
+ const int length = dsp.fVariable.lengthForFrequency(handle->param.sampleRate(), hertz);
+ if (length == dsp.fVariable.getLength()) return PHASEROTATOR_OK;
+ try
+ {
+  dsp.fVariable.setLength(length);
+ }
+ catch (const std::bad_alloc&)
+ {
+  return PHASEROTATOR_OUT_OF_MEMORY;
+ }
+ // Calls on a handle are serialised, so the kernel can be taken up straight away and
+ // the new latency reported at once
+ dsp.fVariable.updateKernel();
+ if (handle->mode == PHASEROTATOR_MODE_FIR_VARIABLE) dsp.setMode(handle->mode);
+ return PHASEROTATOR_OK;
+}
+
+int phaserotator_set_bypass(PhaseRotator *handle, int bypassed)
+{
+ if (handle == nullptr) return PHASEROTATOR_INVALID_ARGUMENT;
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ handle->dsp.setBypass(bypassed != 0);
+ return PHASEROTATOR_OK;
+}
+
+int phaserotator_get_latency(PhaseRotator *handle)
+{
+ if (handle == nullptr) return PHASEROTATOR_INVALID_ARGUMENT;
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ return handle->dsp.getModeLatency(handle->mode);
+}
+
+int phaserotator_reset(PhaseRotator *handle)
+{
+ if (handle == nullptr) return PHASEROTATOR_INVALID_ARGUMENT;
+
+ std::lock_guard<std::mutex> guard(handle->lock);
+ handle->dsp.reset();
+ handle->dsp.manualRotation.snap();
+ handle->dsp.snapBypass();
+ return PHASEROTATOR_OK;
+}
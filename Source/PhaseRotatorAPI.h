@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    PhaseRotatorAPI.h
+    Created: 19 Oct 2026
+
+    A C interface to the phase rotator engine, for hosts that aren't JUCE
+    plugins. It uses the same DSP as the plugin and doesn't depend on JUCE.
+
+    Each handle is safe to use from several threads, as calls on the same
+    handle are serialised. All memory is allocated by phaserotator_create,
+    except for the high quality mode's filter, which is allocated the first
+    time that mode is chosen, and the variable mode's kernel, which is built
+    by phaserotator_set_low_frequency.
+
+    Build the library with PHASEROTATOR_BUILD defined, so that on Windows the
+    functions are exported. Code using the DLL leaves it undefined, and code
+    linking the library statically defines PHASEROTATOR_STATIC.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(PHASEROTATOR_STATIC)
+#define PHASEROTATOR_API
+#elif defined(_WIN32) && defined(PHASEROTATOR_BUILD)
+#define PHASEROTATOR_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define PHASEROTATOR_API __declspec(dllimport)
+#else
+#define PHASEROTATOR_API __attribute__((visibility("default")))
+#endif
+
+typedef struct PhaseRotator PhaseRotator;
+
+// The Hilbert filter modes. The first four match the plugin's mode parameter. The
+// variable mode's length follows phaserotator_set_low_frequency, and the high
+// quality mode is the filter the plugin uses for offline rendering.
+enum
+{
+ PHASEROTATOR_MODE_IIR = 0,
+ PHASEROTATOR_MODE_FIR255 = 1,
+ PHASEROTATOR_MODE_FIR1023 = 2,
+ PHASEROTATOR_MODE_FIR2047 = 3,
+ PHASEROTATOR_MODE_FIR_VARIABLE = 4,
+ PHASEROTATOR_MODE_HIGH_QUALITY = 5
+};
+
+// The stereo modes, matching the plugin's stereo mode parameter
+enum
+{
+ PHASEROTATOR_STEREO_LINKED = 0,
+ PHASEROTATOR_STEREO_INDEPENDENT = 1,
+ PHASEROTATOR_STEREO_MID_SIDE = 2
+};
+
+// Return codes
+enum
+{
+ PHASEROTATOR_OK = 0,
+ PHASEROTATOR_INVALID_ARGUMENT = -1,
+ PHASEROTATOR_OUT_OF_MEMORY = -2
+};
+
+// Creates an engine at the given sample rate. The engine works internally in
+// blocks of at most subBlockSize samples, and pass zero to use the plugin's
+// default. Buffers of any length can be processed. Returns null on failure.
+PHASEROTATOR_API PhaseRotator* phaserotator_create(double sampleRate, int subBlockSize);
+
+PHASEROTATOR_API void phaserotator_destroy(PhaseRotator *handle);
+
+// Processes one or two planar channels in place. A single channel is treated as
+// both sides of a stereo pair.
+PHASEROTATOR_API int phaserotator_process(PhaseRotator *handle, float **channels, int channelCount, int sampleCount);
+
+// Processes one or two interleaved channels in place
+PHASEROTATOR_API int phaserotator_process_interleaved(PhaseRotator *handle, float *samples, int channelCount, int frameCount);
+
+// Sets the rotation in degrees. Changes glide as in the plugin. In linked stereo
+// mode it rotates both channels, and otherwise the left or mid channel.
+PHASEROTATOR_API int phaserotator_set_rotation(PhaseRotator *handle, float degrees);
+
+// Sets the rotation in degrees of the right or side channel, when the stereo mode
+// isn't linked
+PHASEROTATOR_API int phaserotator_set_rotation2(PhaseRotator *handle, float degrees);
+
+PHASEROTATOR_API int phaserotator_set_stereo_mode(PhaseRotator *handle, int stereoMode);
+
+// Returns PHASEROTATOR_OUT_OF_MEMORY if the high quality filter can't be allocated
+PHASEROTATOR_API int phaserotator_set_mode(PhaseRotator *handle, int mode);
+
+// Sets the lowest frequency in Hz that the variable mode rotates accurately, which
+// sets its length and latency. The default is 80Hz.
+PHASEROTATOR_API int phaserotator_set_low_frequency(PhaseRotator *handle, float hertz);
+
+// While bypassed, the input is delayed by the latency of the current mode, after a
+// short crossfade. Pass zero to turn bypass off.
+PHASEROTATOR_API int phaserotator_set_bypass(PhaseRotator *handle, int bypassed);
+
+// Returns the latency of the current mode in samples
+PHASEROTATOR_API int phaserotator_get_latency(PhaseRotator *handle);
+
+// Clears the filter histories
+PHASEROTATOR_API int phaserotator_reset(PhaseRotator *handle);
+
+#ifdef __cplusplus
+}
+#endif
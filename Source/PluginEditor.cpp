@@ -1,90 +1,269 @@
-/*
- ==============================================================================
- 
- This file contains the basic framework code for a JUCE plugin editor.
- 
- ==============================================================================
- */
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-PhaseRotatorAudioProcessorEditor::PhaseRotatorAudioProcessorEditor (PhaseRotatorAudioProcessor& p, juce::AudioProcessorValueTreeState &vts)
-: AudioProcessorEditor (&p), audioProcessor (p), valueTreeState(vts)
-{
- // Make sure that before the constructor has finished, you've set the
- // editor's size to whatever you need it to be.
- setSize (400, 100);
- 
- lookAndFeel = std::make_unique<XDLookAndFeel>();
- 
- addAndMakeVisible(rotationSlider);
- rotationSlider.setBounds(150, 15, 100, 85);
- rotationAttachment.reset(new SliderAttachment(valueTreeState, "rotation", rotationSlider));
- rotationSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
- rotationSlider.setLookAndFeel(lookAndFeel.get());
- rotationSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 48, 15);
- 
- addAndMakeVisible(modeSelector);
- modeSelector.setBounds(150, 0, 100, 15);
- modeAttachment.reset(new ComboBoxAttachment(valueTreeState, "mode", modeSelector));
- modeSelector.addItemList(audioProcessor.ModesList, 1);
- modeSelector.setLookAndFeel(lookAndFeel.get());
- juce::RangedAudioParameter *pr = valueTreeState.getParameter("mode");
- int s = pr->getNormalisableRange().convertFrom0to1(pr->getValue());
- modeSelector.setSelectedId(s + 1, juce::dontSendNotification);
-
- addAndMakeVisible(inputMinimum);
- inputMinimum.setBounds(5, 60, 145, 20);
- addAndMakeVisible(inputMaximum);
- inputMaximum.setBounds(5, 20, 145, 20);
- addAndMakeVisible(outputMinimum);
- outputMinimum.setBounds(255, 60, 145, 20);
- addAndMakeVisible(outputMaximum);
- outputMaximum.setBounds(255, 20, 145, 20);
-
- startTimerHz(10);
-}
-
-PhaseRotatorAudioProcessorEditor::~PhaseRotatorAudioProcessorEditor()
-{
-}
-
-juce::String formatLabel(float x)
-{
- return juce::String(x, 2) + juce::String("dB");
-}
-
-void PhaseRotatorAudioProcessorEditor::timerCallback()
-{
- float t;
- 
- t = audioProcessor.dsp.inputProbe.getMinimumValue(0) + audioProcessor.dsp.inputProbe.getMinimumValue(1);
- inputMinimum.setText(formatLabel(XDDSP::linear2dB(-0.5*t)), juce::dontSendNotification);
- 
- t = audioProcessor.dsp.inputProbe.getMaximumValue(0) + audioProcessor.dsp.inputProbe.getMaximumValue(1);
- inputMaximum.setText(formatLabel(XDDSP::linear2dB(0.5*t)), juce::dontSendNotification);
- 
- t = audioProcessor.dsp.outputProbe.getMinimumValue(0) + audioProcessor.dsp.outputProbe.getMinimumValue(1);
- outputMinimum.setText(formatLabel(XDDSP::linear2dB(-0.5*t)), juce::dontSendNotification);
- 
- t = audioProcessor.dsp.outputProbe.getMaximumValue(0) + audioProcessor.dsp.outputProbe.getMaximumValue(1);
- outputMaximum.setText(formatLabel(XDDSP::linear2dB(0.5*t)), juce::dontSendNotification);
- 
- audioProcessor.dsp.inputProbe.reset();
- audioProcessor.dsp.outputProbe.reset();
-}
-
-//==============================================================================
-void PhaseRotatorAudioProcessorEditor::paint (juce::Graphics& g)
-{
- // (Our component is opaque, so we must completely fill the background with a solid colour)
- g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-}
-
-void PhaseRotatorAudioProcessorEditor::resized()
-{
- // This is generally where you'll want to lay out the positions of any
- // subcomponents in your editor..
-}
+/*
+ ==============================================================================
+ 
+ This file contains the basic framework code for a JUCE plugin editor.
+ 
+ ==============================================================================
+ */
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+PhaseRotatorAudioProcessorEditor::PhaseRotatorAudioProcessorEditor (PhaseRotatorAudioProcessor& p, juce::AudioProcessorValueTreeState &vts)
+: AudioProcessorEditor (&p), audioProcessor (p), valueTreeState(vts)
+{
+ // Make sure that before the constructor has finished, you've set the
+ // editor's size to whatever you need it to be.
+ setSize (400, 250);
+ 
+ lookAndFeel = std::make_unique<XDLookAndFeel>();
+ 
+ addAndMakeVisible(rotationSlider);
+ rotationSlider.setBounds(150, 15, 100, 85);
+ rotationAttachment.reset(new SliderAttachment(valueTreeState, "rotation", rotationSlider));
+ rotationSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+ rotationSlider.setLookAndFeel(lookAndFeel.get());
+ rotationSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 48, 15);
+ 
+ addAndMakeVisible(modeSelector);
+ modeSelector.setBounds(150, 0, 100, 15);
+ modeAttachment.reset(new ComboBoxAttachment(valueTreeState, "mode", modeSelector));
+ modeSelector.addItemList(audioProcessor.ModesList, 1);
+ modeSelector.setLookAndFeel(lookAndFeel.get());
+ juce::RangedAudioParameter *pr = valueTreeState.getParameter("mode");
+ int s = pr->getNormalisableRange().convertFrom0to1(pr->getValue());
+ modeSelector.setSelectedId(s + 1, juce::dontSendNotification);
+ 
+ addAndMakeVisible(variableFirButton);
+ variableFirButton.setBounds(5, 0, 140, 15);
+ variableFirButton.setButtonText("FIR Variable");
+ variableFirAttachment.reset(new ButtonAttachment(valueTreeState, "variableFir", variableFirButton));
+ variableFirButton.setLookAndFeel(lookAndFeel.get());
+ 
+ addChildComponent(lowFrequencySlider);
+ lowFrequencySlider.setBounds(255, 0, 145, 15);
+ lowFrequencyAttachment.reset(new SliderAttachment(valueTreeState, "lowFrequency", lowFrequencySlider));
+ lowFrequencySlider.setSliderStyle(juce::Slider::LinearHorizontal);
+ lowFrequencySlider.setLookAndFeel(lookAndFeel.get());
+ lowFrequencySlider.setTextBoxStyle(juce::Slider::TextBoxRight, true, 48, 15);
+
+ addAndMakeVisible(inputMinimum);
+ inputMinimum.setBounds(5, 60, 145, 20);
+ addAndMakeVisible(inputMaximum);
+ inputMaximum.setBounds(5, 20, 145, 20);
+ addAndMakeVisible(outputMinimum);
+ outputMinimum.setBounds(255, 60, 145, 20);
+ addAndMakeVisible(outputMaximum);
+ outputMaximum.setBounds(255, 20, 145, 20);
+ addAndMakeVisible(envelopeMeter);
+ envelopeMeter.setBounds(5, 40, 145, 20);
+ addAndMakeVisible(frequencyMeter);
+ frequencyMeter.setBounds(255, 40, 145, 20);
+ audioProcessor.analyticMetersActive = true;
+ 
+ addAndMakeVisible(peakReductionButton);
+ peakReductionButton.setBounds(5, 100, 110, 15);
+ peakReductionButton.setButtonText("Peak Reduction");
+ peakReductionAttachment.reset(new ButtonAttachment(valueTreeState, "peakReduction", peakReductionButton));
+ peakReductionButton.setLookAndFeel(lookAndFeel.get());
+ addAndMakeVisible(peakReductionAngle);
+ 
+ addAndMakeVisible(offlineQualityButton);
+ offlineQualityButton.setBounds(150, 100, 100, 15);
+ offlineQualityButton.setButtonText("HQ Offline");
+ offlineQualityAttachment.reset(new ButtonAttachment(valueTreeState, "offlineQuality", offlineQualityButton));
+ offlineQualityButton.setLookAndFeel(lookAndFeel.get());
+ peakReductionAngle.setBounds(255, 100, 145, 15);
+ 
+ addAndMakeVisible(modSourceSelector);
+ modSourceSelector.setBounds(5, 120, 90, 15);
+ modSourceSelector.addItemList(audioProcessor.ModSourcesList, 1);
+ modSourceAttachment.reset(new ComboBoxAttachment(valueTreeState, "modSource", modSourceSelector));
+ modSourceSelector.setLookAndFeel(lookAndFeel.get());
+ 
+ addAndMakeVisible(modDepthSlider);
+ modDepthSlider.setBounds(100, 120, 145, 15);
+ modDepthAttachment.reset(new SliderAttachment(valueTreeState, "modDepth", modDepthSlider));
+ modDepthSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+ modDepthSlider.setLookAndFeel(lookAndFeel.get());
+ modDepthSlider.setTextBoxStyle(juce::Slider::TextBoxRight, true, 48, 15);
+ 
+ addAndMakeVisible(modRateSlider);
+ modRateSlider.setBounds(250, 120, 145, 15);
+ modRateAttachment.reset(new SliderAttachment(valueTreeState, "modRate", modRateSlider));
+ modRateSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+ modRateSlider.setLookAndFeel(lookAndFeel.get());
+ modRateSlider.setTextBoxStyle(juce::Slider::TextBoxRight, true, 48, 15);
+ 
+ addChildComponent(modDivisionSelector);
+ modDivisionSelector.setBounds(250, 120, 145, 15);
+ modDivisionSelector.addItemList(audioProcessor.DivisionsList, 1);
+ modDivisionAttachment.reset(new ComboBoxAttachment(valueTreeState, "modDivision", modDivisionSelector));
+ modDivisionSelector.setLookAndFeel(lookAndFeel.get());
+ 
+ addAndMakeVisible(stereoModeSelector);
+ stereoModeSelector.setBounds(5, 140, 90, 15);
+ stereoModeSelector.addItemList(audioProcessor.StereoModesList, 1);
+ stereoModeAttachment.reset(new ComboBoxAttachment(valueTreeState, "stereoMode", stereoModeSelector));
+ stereoModeSelector.setLookAndFeel(lookAndFeel.get());
+ 
+ addAndMakeVisible(rotation2Slider);
+ rotation2Slider.setBounds(100, 140, 145, 15);
+ rotation2Attachment.reset(new SliderAttachment(valueTreeState, "rotation2", rotation2Slider));
+ rotation2Slider.setSliderStyle(juce::Slider::LinearHorizontal);
+ rotation2Slider.setLookAndFeel(lookAndFeel.get());
+ rotation2Slider.setTextBoxStyle(juce::Slider::TextBoxRight, true, 48, 15);
+
+ // Click either scope to change the time span
+ addAndMakeVisible(inputScope);
+ inputScope.setBounds(5, 165, ScopeWidth, 80);
+ inputScope.addMouseListener(this, false);
+ addAndMakeVisible(outputScope);
+ outputScope.setBounds(205, 165, ScopeWidth, 80);
+ outputScope.addMouseListener(this, false);
+ audioProcessor.inputScope.setActive(true);
+ audioProcessor.outputScope.setActive(true);
+ 
+ addAndMakeVisible(analyzerButton);
+ analyzerButton.setBounds(255, 140, 140, 15);
+ analyzerButton.setButtonText("Analyzer");
+ analyzerButton.setLookAndFeel(lookAndFeel.get());
+ analyzerButton.onClick = [&]() { showAnalyzer(analyzerButton.getToggleState()); };
+ addChildComponent(analyzerView);
+ analyzerView.setBounds(5, 250, 390, 150);
+
+ startTimerHz(30);
+}
+
+PhaseRotatorAudioProcessorEditor::~PhaseRotatorAudioProcessorEditor()
+{
+ audioProcessor.analyticMetersActive = false;
+ audioProcessor.analyzerFeed.setActive(false);
+ analyzerWorker.reset();
+ audioProcessor.inputScope.setActive(false);
+ audioProcessor.outputScope.setActive(false);
+}
+
+void PhaseRotatorAudioProcessorEditor::showAnalyzer(bool show)
+{
+ // The worker only exists while the analyzer is on screen, so a closed analyzer costs
+ // nothing on any thread
+ if (show && analyzerWorker == nullptr)
+ {
+  analyzerWorker = std::make_unique<AnalyzerWorker>(audioProcessor.analyzerFeed);
+  audioProcessor.analyzerFeed.setActive(true);
+  analyzerWorker->startThread();
+ }
+ else if (!show && analyzerWorker != nullptr)
+ {
+  audioProcessor.analyzerFeed.setActive(false);
+  analyzerWorker->stopThread(1000);
+  analyzerWorker.reset();
+ }
+ 
+ analyzerView.setVisible(show);
+ setSize(400, show ? 405 : 250);
+}
+
+void PhaseRotatorAudioProcessorEditor::mouseDown(const juce::MouseEvent &event)
+{
+ if (event.eventComponent == &inputScope || event.eventComponent == &outputScope)
+ {
+  scopeLevel = (scopeLevel + 1) % Scope::LevelCount;
+  inputScope.clear();
+  outputScope.clear();
+ }
+}
+
+void PhaseRotatorAudioProcessorEditor::updateScope(Scope &feed, WaveformDisplay<ScopeWidth> &display)
+{
+ // Only the level on display is read, the rest are thrown away
+ for (int l = 0; l < Scope::LevelCount; ++l)
+ {
+  if (l != scopeLevel) feed.discard(l);
+ }
+ 
+ int n;
+ while ((n = feed.pull(scopeLevel, scopeBins.data(), ScopeWidth)) > 0)
+ {
+  display.pushColumns(scopeBins.begin(), scopeBins.begin() + n);
+ }
+}
+
+juce::String formatLabel(float x)
+{
+ return juce::String(x, 2) + juce::String("dB");
+}
+
+void PhaseRotatorAudioProcessorEditor::timerCallback()
+{
+ updateScope(audioProcessor.inputScope, inputScope);
+ updateScope(audioProcessor.outputScope, outputScope);
+ 
+ if (analyzerWorker && analyzerWorker->collect(analyzerResult, analyzerVersion))
+ {
+  analyzerView.setResult(analyzerResult);
+ }
+ 
+ // The labels show peaks over a third of a second
+ if (labelCountdown-- > 0) return;
+ labelCountdown = 2;
+ 
+ float t;
+ 
+ t = audioProcessor.dsp.inputProbe.getMinimumValue(0) + audioProcessor.dsp.inputProbe.getMinimumValue(1);
+ inputMinimum.setText(formatLabel(XDDSP::linear2dB(-0.5*t)), juce::dontSendNotification);
+ 
+ t = audioProcessor.dsp.inputProbe.getMaximumValue(0) + audioProcessor.dsp.inputProbe.getMaximumValue(1);
+ inputMaximum.setText(formatLabel(XDDSP::linear2dB(0.5*t)), juce::dontSendNotification);
+ 
+ t = audioProcessor.dsp.outputProbe.getMinimumValue(0) + audioProcessor.dsp.outputProbe.getMinimumValue(1);
+ outputMinimum.setText(formatLabel(XDDSP::linear2dB(-0.5*t)), juce::dontSendNotification);
+ 
+ t = audioProcessor.dsp.outputProbe.getMaximumValue(0) + audioProcessor.dsp.outputProbe.getMaximumValue(1);
+ outputMaximum.setText(formatLabel(XDDSP::linear2dB(0.5*t)), juce::dontSendNotification);
+ 
+ const bool synced = (modSourceSelector.getSelectedItemIndex() == PhaseRotatorAudioProcessor::ModulationLFOSync);
+ modRateSlider.setVisible(! synced);
+ modDivisionSelector.setVisible(synced);
+ // The variable FIR takes the place of the chosen mode
+ const bool variableFir = variableFirButton.getToggleState();
+ lowFrequencySlider.setVisible(variableFir);
+ modeSelector.setEnabled(! variableFir);
+ rotation2Slider.setEnabled(stereoModeSelector.getSelectedItemIndex() != PhaseRotatorAudioProcessor::StereoLinked);
+ 
+ if (audioProcessor.dsp.peakReducer.isEnabled())
+ {
+  t = audioProcessor.dsp.peakReducer.getCurrentAngle() / M_PI * 180.;
+  peakReductionAngle.setText(juce::String(t, 1) + juce::String(" deg"), juce::dontSendNotification);
+ }
+ else
+ {
+  peakReductionAngle.setText({}, juce::dontSendNotification);
+ }
+ 
+ if (audioProcessor.dsp.analytic.isEnabled())
+ {
+  t = audioProcessor.dsp.analytic.takeEnvelopePeak(0) + audioProcessor.dsp.analytic.takeEnvelopePeak(1);
+  envelopeMeter.setText(juce::String("Env ") + formatLabel(XDDSP::linear2dB(0.5*t)), juce::dontSendNotification);
+  t = audioProcessor.dsp.analytic.getMeanFrequency();
+  frequencyMeter.setText(juce::String("Freq ") + juce::String(t, 0) + juce::String("Hz"), juce::dontSendNotification);
+ }
+ 
+ audioProcessor.dsp.inputProbe.reset();
+ audioProcessor.dsp.outputProbe.reset();
+}
+
+//==============================================================================
+void PhaseRotatorAudioProcessorEditor::paint (juce::Graphics& g)
+{
+ // (Our component is opaque, so we must completely fill the background with a solid colour)
+ g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+}
+
+void PhaseRotatorAudioProcessorEditor::resized()
+{
+ // This is generally where you'll want to lay out the positions of any
+ // subcomponents in your editor..
+}
@@ -1,53 +1,100 @@
-/*
- ==============================================================================
- 
- This file contains the basic framework code for a JUCE plugin editor.
- 
- ==============================================================================
- */
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "PluginProcessor.h"
-#include "LookAndFeel.h"
-
-//==============================================================================
-/**
- */
-class PhaseRotatorAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Timer
-{
-public:
- PhaseRotatorAudioProcessorEditor (PhaseRotatorAudioProcessor&, juce::AudioProcessorValueTreeState&);
- ~PhaseRotatorAudioProcessorEditor() override;
- 
- //==============================================================================
- void paint (juce::Graphics&) override;
- void resized() override;
- 
- virtual void timerCallback() override;
- 
-private:
- typedef juce::AudioProcessorValueTreeState::SliderAttachment SliderAttachment;
- typedef juce::AudioProcessorValueTreeState::ButtonAttachment ButtonAttachment;
- typedef juce::AudioProcessorValueTreeState::ComboBoxAttachment ComboBoxAttachment;
- // This reference is provided as a quick way for your editor to
- // access the processor object that created it.
- PhaseRotatorAudioProcessor& audioProcessor;
- juce::AudioProcessorValueTreeState& valueTreeState;
- 
- std::unique_ptr<XDLookAndFeel> lookAndFeel;
- 
- juce::Label inputMinimum;
- juce::Label inputMaximum;
- juce::Label outputMinimum;
- juce::Label outputMaximum;
- 
- juce::Slider rotationSlider;
- std::unique_ptr<SliderAttachment> rotationAttachment;
- 
- juce::ComboBox modeSelector;
- std::unique_ptr<ComboBoxAttachment> modeAttachment;
- 
- JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PhaseRotatorAudioProcessorEditor)
-};
+/*
+ ==============================================================================
+ 
+ This file contains the basic framework code for a JUCE plugin editor.
+ 
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "LookAndFeel.h"
+
+//==============================================================================
+/**
+ */
+class PhaseRotatorAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Timer
+{
+public:
+ PhaseRotatorAudioProcessorEditor (PhaseRotatorAudioProcessor&, juce::AudioProcessorValueTreeState&);
+ ~PhaseRotatorAudioProcessorEditor() override;
+ 
+ //==============================================================================
+ void paint (juce::Graphics&) override;
+ void resized() override;
+ 
+ virtual void timerCallback() override;
+ 
+ void mouseDown(const juce::MouseEvent &event) override;
+ 
+private:
+ typedef juce::AudioProcessorValueTreeState::SliderAttachment SliderAttachment;
+ typedef juce::AudioProcessorValueTreeState::ButtonAttachment ButtonAttachment;
+ typedef juce::AudioProcessorValueTreeState::ComboBoxAttachment ComboBoxAttachment;
+ // This reference is provided as a quick way for your editor to
+ // access the processor object that created it.
+ PhaseRotatorAudioProcessor& audioProcessor;
+ juce::AudioProcessorValueTreeState& valueTreeState;
+ 
+ std::unique_ptr<XDLookAndFeel> lookAndFeel;
+ 
+ juce::Label inputMinimum;
+ juce::Label inputMaximum;
+ juce::Label outputMinimum;
+ juce::Label outputMaximum;
+ juce::Label envelopeMeter;
+ juce::Label frequencyMeter;
+ 
+ static constexpr int ScopeWidth = 190;
+ typedef PhaseRotatorAudioProcessor::Scope Scope;
+ WaveformDisplay<ScopeWidth> inputScope;
+ WaveformDisplay<ScopeWidth> outputScope;
+ std::array<Scope::Bin, ScopeWidth> scopeBins;
+ int scopeLevel {2};
+ int labelCountdown {0};
+ 
+ void updateScope(Scope &feed, WaveformDisplay<ScopeWidth> &display);
+ 
+ juce::ToggleButton analyzerButton;
+ AnalyzerView analyzerView;
+ std::unique_ptr<AnalyzerWorker> analyzerWorker;
+ AnalyzerResult analyzerResult;
+ int analyzerVersion {0};
+ 
+ void showAnalyzer(bool show);
+ 
+ juce::Slider rotationSlider;
+ std::unique_ptr<SliderAttachment> rotationAttachment;
+ 
+ juce::ComboBox modeSelector;
+ std::unique_ptr<ComboBoxAttachment> modeAttachment;
+ juce::ToggleButton variableFirButton;
+ std::unique_ptr<ButtonAttachment> variableFirAttachment;
+ juce::Slider lowFrequencySlider;
+ std::unique_ptr<SliderAttachment> lowFrequencyAttachment;
+ 
+ juce::ComboBox stereoModeSelector;
+ std::unique_ptr<ComboBoxAttachment> stereoModeAttachment;
+ juce::Slider rotation2Slider;
+ std::unique_ptr<SliderAttachment> rotation2Attachment;
+ 
+ juce::ToggleButton peakReductionButton;
+ std::unique_ptr<ButtonAttachment> peakReductionAttachment;
+ juce::Label peakReductionAngle;
+ 
+ juce::ToggleButton offlineQualityButton;
+ std::unique_ptr<ButtonAttachment> offlineQualityAttachment;
+ 
+ juce::ComboBox modSourceSelector;
+ std::unique_ptr<ComboBoxAttachment> modSourceAttachment;
+ juce::Slider modDepthSlider;
+ std::unique_ptr<SliderAttachment> modDepthAttachment;
+ juce::Slider modRateSlider;
+ std::unique_ptr<SliderAttachment> modRateAttachment;
+ juce::ComboBox modDivisionSelector;
+ std::unique_ptr<ComboBoxAttachment> modDivisionAttachment;
+ 
+ JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PhaseRotatorAudioProcessorEditor)
+};
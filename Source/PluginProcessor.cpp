@@ -1,238 +1,651 @@
-/*
- ==============================================================================
- 
- This file contains the basic framework code for a JUCE plugin processor.
- 
- ==============================================================================
- */
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-static constexpr int PluginParameterVersion = 2;
-
-//==============================================================================
-PhaseRotatorAudioProcessor::PhaseRotatorAudioProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
-: AudioProcessor (BusesProperties()
-#if ! JucePlugin_IsMidiEffect
-#if ! JucePlugin_IsSynth
-                  .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-#endif
-                  .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-#endif
-                  )
-#endif
-,
-dsp(dspParam),
-parameters(*this, nullptr, juce::Identifier("PhaseRotator"),
-{
- std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("rotation", PluginParameterVersion), "Rotation", juce::NormalisableRange<float>(-180.,180.,1.0), 0., "deg"),
- std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("mode", PluginParameterVersion), "Mode", ModesList, 0)
-})
-{
- {
-  // Rotation Parameter
-  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("rotation"), [&](float newValue)
-  {
-   dsp.rotator.rotationIn.setControl(newValue / 180. * M_PI);
-  });
-  parameters.getParameter("rotation")->addListener(listener);
-  rotationListen = std::unique_ptr<PluginParameterListener>(listener);
- }
-
- {
-  // Rotation Parameter
-  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("mode"), [&](float newValue)
-  {
-   dsp.setMode((int)newValue);
-   switch ((int)newValue)
-   {
-    case 0:
-    default:
-     setLatencySamples(0);
-     break;
-     
-    case 1:
-     setLatencySamples(dsp.f255.DelayLength);
-     break;
-     
-    case 2:
-     setLatencySamples(dsp.f1023.DelayLength);
-     break;
-     
-    case 3:
-     setLatencySamples(dsp.f2047.DelayLength);
-     break;
-   }
-  });
-  parameters.getParameter("mode")->addListener(listener);
-  modeListen = std::unique_ptr<PluginParameterListener>(listener);
- }
-}
-
-PhaseRotatorAudioProcessor::~PhaseRotatorAudioProcessor()
-{
-}
-
-//==============================================================================
-const juce::String PhaseRotatorAudioProcessor::getName() const
-{
- return JucePlugin_Name;
-}
-
-bool PhaseRotatorAudioProcessor::acceptsMidi() const
-{
-#if JucePlugin_WantsMidiInput
- return true;
-#else
- return false;
-#endif
-}
-
-bool PhaseRotatorAudioProcessor::producesMidi() const
-{
-#if JucePlugin_ProducesMidiOutput
- return true;
-#else
- return false;
-#endif
-}
-
-bool PhaseRotatorAudioProcessor::isMidiEffect() const
-{
-#if JucePlugin_IsMidiEffect
- return true;
-#else
- return false;
-#endif
-}
-
-double PhaseRotatorAudioProcessor::getTailLengthSeconds() const
-{
- return 0.0;
-}
-
-int PhaseRotatorAudioProcessor::getNumPrograms()
-{
- return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
- // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int PhaseRotatorAudioProcessor::getCurrentProgram()
-{
- return 0;
-}
-
-void PhaseRotatorAudioProcessor::setCurrentProgram (int index)
-{
-}
-
-const juce::String PhaseRotatorAudioProcessor::getProgramName (int index)
-{
- return {};
-}
-
-void PhaseRotatorAudioProcessor::changeProgramName (int index, const juce::String& newName)
-{
-}
-
-//==============================================================================
-void PhaseRotatorAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
-{
- dspParam.setSampleRate(sampleRate);
- dspParam.setBufferSize(samplesPerBlock);
- monobuf.resize(samplesPerBlock);
- 
- rotationListen->sendInternalUpdate();
-}
-
-void PhaseRotatorAudioProcessor::releaseResources()
-{
- // When playback stops, you can use this as an opportunity to free up any
- // spare memory, etc.
-}
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool PhaseRotatorAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
-{
-#if JucePlugin_IsMidiEffect
- juce::ignoreUnused (layouts);
- return true;
-#else
- // This is the place where you check if the layout is supported.
- // In this template code we only support mono or stereo.
- // Some plugin hosts, such as certain GarageBand versions, will only
- // load plugins that support stereo bus layouts.
- if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-  return false;
- 
- // This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
- if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-  return false;
-#endif
- 
- return true;
-#endif
-}
-#endif
-
-void PhaseRotatorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
-{
- juce::ScopedNoDenormals noDenormals;
- if (buffer.getNumChannels() == 1)
- {
-  dsp.floatInput.connect({buffer.getWritePointer(0), monobuf.data()});
-  dsp.process(0, buffer.getNumSamples());
-  dsp.rotator.signalOut.fastTransfer<float>({buffer.getWritePointer(0), monobuf.data()}, buffer.getNumSamples());
- }
- else
- {
-  dsp.floatInput.connect({buffer.getWritePointer(0), buffer.getWritePointer(1)});
-  dsp.process(0, buffer.getNumSamples());
-  dsp.rotator.signalOut.fastTransfer<float>({buffer.getWritePointer(0), buffer.getWritePointer(1)}, buffer.getNumSamples());
- }
-}
-
-//==============================================================================
-bool PhaseRotatorAudioProcessor::hasEditor() const
-{
- return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* PhaseRotatorAudioProcessor::createEditor()
-{
- return new PhaseRotatorAudioProcessorEditor (*this, parameters);
-// return new juce::GenericAudioProcessorEditor(*this);
-}
-
-//==============================================================================
-void PhaseRotatorAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{
- auto p = parameters.copyState();
- std::unique_ptr<juce::XmlElement> xml(p.createXml());
- copyXmlToBinary(*xml, destData);
-}
-
-void PhaseRotatorAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
-{
- std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
- 
- if (xmlState.get() != nullptr)
- {
-  if (xmlState->hasTagName (parameters.state.getType()))
-  {
-   juce::ValueTree p = juce::ValueTree::fromXml(*xmlState);
-   parameters.replaceState(p);
-  }
- }
-}
-
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
- return new PhaseRotatorAudioProcessor();
-}
+/*
+ ==============================================================================
+ 
+ This file contains the basic framework code for a JUCE plugin processor.
+ 
+ ==============================================================================
+ */
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+static constexpr int PluginParameterVersion = 2;
+
+// Binary state chunks start with this tag and a format version, so they can be told
+// apart from the XML chunks written by earlier versions
+static constexpr int StateMagic = 0x50525354;
+static constexpr int StateVersion = 1;
+
+//==============================================================================
+PhaseRotatorAudioProcessor::PhaseRotatorAudioProcessor()
+#ifndef JucePlugin_PreferredChannelConfigurations
+: AudioProcessor (BusesProperties()
+#if ! JucePlugin_IsMidiEffect
+#if ! JucePlugin_IsSynth
+                  .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                  .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
+#endif
+                  .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                  .withOutput ("Envelope", juce::AudioChannelSet::stereo(), false)
+                  .withOutput ("Phase", juce::AudioChannelSet::stereo(), false)
+                  .withOutput ("Frequency", juce::AudioChannelSet::stereo(), false)
+#endif
+                  )
+#endif
+,
+dsp(dspParam),
+parameters(*this, nullptr, juce::Identifier("PhaseRotator"),
+{
+ std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("rotation", PluginParameterVersion), "Rotation", juce::NormalisableRange<float>(-180.,180.,1.0), 0., "deg"),
+ std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("mode", PluginParameterVersion), "Mode", ModesList, 0),
+ std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("stereoMode", PluginParameterVersion), "Stereo Mode", StereoModesList, 0),
+ std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("rotation2", PluginParameterVersion), "Rotation R/S", juce::NormalisableRange<float>(-180.,180.,1.0), 0., "deg"),
+ std::make_unique<juce::AudioParameterBool>(juce::ParameterID("peakReduction", PluginParameterVersion), "Peak Reduction", false),
+ std::make_unique<juce::AudioParameterBool>(juce::ParameterID("offlineQuality", PluginParameterVersion), "HQ Offline Render", false),
+ std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("modSource", PluginParameterVersion), "Modulation Source", ModSourcesList, 0),
+ std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("modDepth", PluginParameterVersion), "Modulation Depth", juce::NormalisableRange<float>(0.,180.,1.0), 45., "deg"),
+ std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("modRate", PluginParameterVersion), "Modulation Rate", juce::NormalisableRange<float>(0.01,20.,0.01,0.3), 1., "Hz"),
+ std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("modDivision", PluginParameterVersion), "Modulation Sync", DivisionsList, 2),
+ std::make_unique<juce::AudioParameterBool>(juce::ParameterID("bypass", PluginParameterVersion), "Bypass", false),
+ std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("lowFrequency", PluginParameterVersion), "Lowest Frequency", juce::NormalisableRange<float>(20.,1000.,1.0,0.3), 80., "Hz"),
+ std::make_unique<juce::AudioParameterBool>(juce::ParameterID("variableFir", PluginParameterVersion), "FIR Variable", false)
+})
+{
+ {
+  // Rotation Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("rotation"), [&](float newValue)
+  {
+   rotation = newValue;
+   updateRotation();
+  });
+  parameters.getParameter("rotation")->addListener(listener);
+  rotationListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Second Rotation Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("rotation2"), [&](float newValue)
+  {
+   rotation2 = newValue;
+   updateRotation();
+  });
+  parameters.getParameter("rotation2")->addListener(listener);
+  rotation2Listen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Stereo Mode Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("stereoMode"), [&](float newValue)
+  {
+   stereoMode = (int)newValue;
+   dsp.rotator.setMidSide(stereoMode == StereoMidSide);
+   updateRotation();
+  });
+  parameters.getParameter("stereoMode")->addListener(listener);
+  stereoModeListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Rotation Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("mode"), [&](float newValue)
+  {
+   mode = (int)newValue;
+   engineChanged = true;
+  });
+  parameters.getParameter("mode")->addListener(listener);
+  modeListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Peak Reduction Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("peakReduction"), [&](float newValue)
+  {
+   dsp.setPeakReduction(newValue > 0.5);
+  });
+  parameters.getParameter("peakReduction")->addListener(listener);
+  peakReductionListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Offline Quality Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("offlineQuality"), [&](float newValue)
+  {
+   offlineQuality = newValue > 0.5;
+   if (offlineQuality) triggerAsyncUpdate();
+   engineChanged = true;
+  });
+  parameters.getParameter("offlineQuality")->addListener(listener);
+  offlineQualityListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Modulation Source Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("modSource"), [&](float newValue)
+  {
+   modSource = (int)newValue;
+   switch (modSource)
+   {
+    case ModulationOff:
+    default:
+     dsp.modulator.setSource(XDDSP::PhaseRotatorDSP::Modulator::Off);
+     break;
+     
+    case ModulationLFO:
+     dsp.modulator.setSource(XDDSP::PhaseRotatorDSP::Modulator::LFO);
+     modRateListen->sendInternalUpdate();
+     break;
+     
+    case ModulationLFOSync:
+     dsp.modulator.setSource(XDDSP::PhaseRotatorDSP::Modulator::LFO);
+     break;
+     
+    case ModulationEnvelope:
+    case ModulationSidechain:
+     dsp.modulator.setSource(XDDSP::PhaseRotatorDSP::Modulator::Envelope);
+     break;
+   }
+  });
+  parameters.getParameter("modSource")->addListener(listener);
+  modSourceListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Modulation Depth Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("modDepth"), [&](float newValue)
+  {
+   dsp.modulator.setDepth(newValue / 180. * M_PI);
+  });
+  parameters.getParameter("modDepth")->addListener(listener);
+  modDepthListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Modulation Rate Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("modRate"), [&](float newValue)
+  {
+   if (modSource != ModulationLFOSync) dsp.modulator.setRate(newValue);
+  });
+  parameters.getParameter("modRate")->addListener(listener);
+  modRateListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Modulation Sync Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("modDivision"), [&](float newValue)
+  {
+   static constexpr float beats[] = {16., 8., 4., 2., 1., 0.5, 0.25};
+   beatsPerCycle = beats[juce::jlimit(0, 6, (int)newValue)];
+  });
+  parameters.getParameter("modDivision")->addListener(listener);
+  modDivisionListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Bypass Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("bypass"), [&](float newValue)
+  {
+   bypass = newValue > 0.5;
+  });
+  parameters.getParameter("bypass")->addListener(listener);
+  bypassListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Lowest Frequency Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("lowFrequency"), [&](float newValue)
+  {
+   // This can be called on the audio thread, so the kernel is built later
+   lowFrequency = newValue;
+   triggerAsyncUpdate();
+  });
+  parameters.getParameter("lowFrequency")->addListener(listener);
+  lowFrequencyListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+
+ {
+  // Variable FIR Parameter
+  PluginParameterListener *listener = new PluginParameterListener(parameters.getParameter("variableFir"), [&](float newValue)
+  {
+   variableFir = newValue > 0.5;
+   engineChanged = true;
+  });
+  parameters.getParameter("variableFir")->addListener(listener);
+  variableFirListen = std::unique_ptr<PluginParameterListener>(listener);
+ }
+}
+
+PhaseRotatorAudioProcessor::~PhaseRotatorAudioProcessor()
+{
+ cancelPendingUpdate();
+}
+
+//==============================================================================
+const juce::String PhaseRotatorAudioProcessor::getName() const
+{
+ return JucePlugin_Name;
+}
+
+bool PhaseRotatorAudioProcessor::acceptsMidi() const
+{
+#if JucePlugin_WantsMidiInput
+ return true;
+#else
+ return false;
+#endif
+}
+
+bool PhaseRotatorAudioProcessor::producesMidi() const
+{
+#if JucePlugin_ProducesMidiOutput
+ return true;
+#else
+ return false;
+#endif
+}
+
+bool PhaseRotatorAudioProcessor::isMidiEffect() const
+{
+#if JucePlugin_IsMidiEffect
+ return true;
+#else
+ return false;
+#endif
+}
+
+double PhaseRotatorAudioProcessor::getTailLengthSeconds() const
+{
+ return 0.0;
+}
+
+int PhaseRotatorAudioProcessor::getNumPrograms()
+{
+ return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+ // so this should be at least 1, even if you're not really implementing programs.
+}
+
+int PhaseRotatorAudioProcessor::getCurrentProgram()
+{
+ return 0;
+}
+
+void PhaseRotatorAudioProcessor::setCurrentProgram (int index)
+{
+}
+
+const juce::String PhaseRotatorAudioProcessor::getProgramName (int index)
+{
+ return {};
+}
+
+void PhaseRotatorAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+}
+
+//==============================================================================
+void PhaseRotatorAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+ juce::ignoreUnused(samplesPerBlock);
+ dspParam.setSampleRate(sampleRate);
+ analyzerFeed.setSampleRate(sampleRate);
+ 
+ // Offline renders can afford bigger sub-blocks
+ preparedSubBlockSize = (offlineQuality && isNonRealtime()) ? OfflineSubBlockSize : SubBlockSize;
+ dspParam.setBufferSize(preparedSubBlockSize);
+ monobuf.resize(preparedSubBlockSize);
+ sidebuf.resize(preparedSubBlockSize);
+ silence.assign(preparedSubBlockSize, 0.f);
+ 
+ rotationListen->sendInternalUpdate();
+ rotation2Listen->sendInternalUpdate();
+ stereoModeListen->sendInternalUpdate();
+ dsp.manualRotation.snap();
+ peakReductionListen->sendInternalUpdate();
+ offlineQualityListen->sendInternalUpdate();
+ if (offlineQuality) dsp.allocateHighQuality();
+ lowFrequencyListen->sendInternalUpdate();
+ updateVariableKernel();
+ variableFirListen->sendInternalUpdate();
+ modeListen->sendInternalUpdate();
+ modSourceListen->sendInternalUpdate();
+ modDepthListen->sendInternalUpdate();
+ modRateListen->sendInternalUpdate();
+ modDivisionListen->sendInternalUpdate();
+ bypassListen->sendInternalUpdate();
+ 
+ // The audio thread isn't running, so the engine is set up here, and the latency is
+ // known before the first block
+ dsp.fVariable.updateKernel();
+ engineChanged = false;
+ updateEngine();
+ dsp.modulator.reset();
+ dsp.setBypass(bypass);
+ dsp.snapBypass();
+}
+
+void PhaseRotatorAudioProcessor::updateRotation()
+{
+ // In linked mode both channels follow the first rotation. Otherwise the second
+ // rotation drives the right channel, or the side signal in mid/side mode.
+ const float second = (stereoMode == StereoLinked) ? rotation : rotation2;
+ dsp.manualRotation.setControl(0, rotation / 180. * M_PI);
+ dsp.manualRotation.setControl(1, second / 180. * M_PI);
+}
+
+void PhaseRotatorAudioProcessor::updateEngine()
+{
+ // With high quality offline rendering on, the latency of the offline engine is always
+ // reported, and the realtime modes are delayed to match. The host sees the same
+ // latency whether it is rendering or playing, so bounces stay aligned. The offline
+ // engine is kept primed while playing, so a render starts with its history full.
+ // Until its memory has been allocated, the option has no effect. Called on the audio
+ // thread, or from prepareToPlay.
+ renderingOffline = isNonRealtime();
+ const bool highQuality = offlineQuality && dsp.isHighQualityAllocated();
+ const int playing = variableFir ? static_cast<int>(XDDSP::PhaseRotatorDSP::VariableMode) : mode.load();
+ const int engine = (highQuality && renderingOffline) ? XDDSP::PhaseRotatorDSP::HighQualityMode : playing;
+ const int engineLatency = dsp.getModeLatency(engine);
+ int latency = dsp.getModeLatency(playing);
+ if (highQuality) latency = std::max(latency, dsp.getModeLatency(XDDSP::PhaseRotatorDSP::HighQualityMode));
+ 
+ dsp.setHighQualityPrimed(highQuality && !renderingOffline);
+ dsp.setMode(engine);
+ dsp.setCompensationDelay(latency - engineLatency);
+ setLatencySamples(latency);
+ analyzerFeed.setLatency(latency);
+}
+
+void PhaseRotatorAudioProcessor::updateVariableKernel()
+{
+ // The shortest kernel that is accurate down to the lowest frequency at this sample
+ // rate, which keeps the latency and CPU cost down. The audio thread updates the
+ // latency when it takes the kernel up.
+ const int length = dsp.fVariable.lengthForFrequency(getSampleRate(), lowFrequency);
+ if (length == dsp.fVariable.getLength()) return;
+ dsp.fVariable.setLength(length);
+}
+
+void PhaseRotatorAudioProcessor::handleAsyncUpdate()
+{
+ if (offlineQuality && !dsp.isHighQualityAllocated())
+ {
+  dsp.allocateHighQuality();
+  engineChanged = true;
+ }
+ updateVariableKernel();
+}
+
+void PhaseRotatorAudioProcessor::releaseResources()
+{
+ // When playback stops, you can use this as an opportunity to free up any
+ // spare memory, etc.
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool PhaseRotatorAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+#if JucePlugin_IsMidiEffect
+ juce::ignoreUnused (layouts);
+ return true;
+#else
+ // This is the place where you check if the layout is supported.
+ // In this template code we only support mono or stereo.
+ // Some plugin hosts, such as certain GarageBand versions, will only
+ // load plugins that support stereo bus layouts.
+ if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+  return false;
+ 
+ // The analytic side outputs are optional and follow the main output layout
+ for (int b = EnvelopeBus; b < layouts.outputBuses.size(); ++b)
+ {
+  const juce::AudioChannelSet side = layouts.getChannelSet(false, b);
+  if (! side.isDisabled() && side != layouts.getMainOutputChannelSet())
+   return false;
+ }
+ 
+ // This checks if the input layout matches the output layout
+#if ! JucePlugin_IsSynth
+ if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+  return false;
+ 
+ // The sidechain is optional and may be mono or stereo
+ if (layouts.inputBuses.size() > 1)
+ {
+  const juce::AudioChannelSet key = layouts.getChannelSet(true, 1);
+  if (! key.isDisabled()
+      && key != juce::AudioChannelSet::mono()
+      && key != juce::AudioChannelSet::stereo())
+   return false;
+ }
+#endif
+ 
+ return true;
+#endif
+}
+#endif
+
+void PhaseRotatorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+ process(buffer, bypass);
+}
+
+void PhaseRotatorAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+ // Hosts that bypass the plugin themselves still get the delayed dry signal, so the
+ // track stays aligned
+ process(buffer, true);
+}
+
+juce::AudioProcessorParameter* PhaseRotatorAudioProcessor::getBypassParameter() const
+{
+ return parameters.getParameter("bypass");
+}
+
+void PhaseRotatorAudioProcessor::process (juce::AudioBuffer<float>& buffer, bool bypassed)
+{
+ juce::ScopedNoDenormals noDenormals;
+ const bool kernelChanged = dsp.fVariable.updateKernel();
+ if (engineChanged.exchange(false) || kernelChanged || renderingOffline != isNonRealtime()) updateEngine();
+ dsp.setBypass(bypassed);
+ 
+ auto mainBuffer = getBusBuffer(buffer, false, 0);
+ const int sampleCount = buffer.getNumSamples();
+ float *left = mainBuffer.getWritePointer(0);
+ float *right = (mainBuffer.getNumChannels() == 1) ? nullptr : mainBuffer.getWritePointer(1);
+ 
+ // With the sidechain chosen but no sidechain bus enabled, the key is silent and the
+ // rotation isn't modulated
+ float *keyLeft = nullptr;
+ float *keyRight = nullptr;
+ if (modSource == ModulationSidechain && getBusCount(true) > 1)
+ {
+  auto keyBuffer = getBusBuffer(buffer, true, 1);
+  if (keyBuffer.getNumChannels() > 0)
+  {
+   keyLeft = keyBuffer.getWritePointer(0);
+   keyRight = (keyBuffer.getNumChannels() == 1) ? keyLeft : keyBuffer.getWritePointer(1);
+  }
+ }
+ 
+ // The analytic side outputs are computed if the host has enabled any of them, or if
+ // the editor is showing their meters. Output bus channels can share the buffer with
+ // the sidechain, which is safe because each sub-block of the key is read before the
+ // same sub-block of the side outputs is written.
+ std::array<std::array<float*, 2>, 3> side {};
+ bool sideOutputs = false;
+ for (int b = 0; b < 3; ++b)
+ {
+  if (getBusCount(false) > EnvelopeBus + b)
+  {
+   auto sideBuffer = getBusBuffer(buffer, false, EnvelopeBus + b);
+   if (sideBuffer.getNumChannels() > 0)
+   {
+    side[b] = {sideBuffer.getWritePointer(0), (sideBuffer.getNumChannels() == 1) ? nullptr : sideBuffer.getWritePointer(1)};
+    sideOutputs = true;
+   }
+  }
+ }
+ const bool analyticMeters = sideOutputs || analyticMetersActive;
+ if (analyticMeters != dsp.analytic.isEnabled() || sideOutputs != dsp.analytic.hasOutputs())
+ {
+  dsp.setAnalysis(analyticMeters, sideOutputs);
+ }
+ 
+ if (modSource == ModulationLFOSync)
+ {
+  if (auto *playHead = getPlayHead())
+  {
+   if (auto position = playHead->getPosition())
+   {
+    if (position->getPpqPosition().hasValue() && position->getBpm().hasValue())
+    {
+     dsp.modulator.setSyncPosition(*position->getPpqPosition(), *position->getBpm(), beatsPerCycle);
+    }
+   }
+  }
+ }
+ 
+ // Walk the host buffer in sub-blocks so that any host buffer size is safe and the
+ // intermediate buffers never grow beyond what was allocated in prepareToPlay
+ for (int offset = 0; offset < sampleCount; offset += preparedSubBlockSize)
+ {
+  const int n = std::min(preparedSubBlockSize, sampleCount - offset);
+  if (right == nullptr) std::copy(left + offset, left + offset + n, monobuf.begin());
+  std::array<float*, 2> io {left + offset, right ? right + offset : monobuf.data()};
+  dsp.floatInput.connect(io);
+  if (keyLeft) dsp.keyInput.connect({keyLeft + offset, keyRight + offset});
+  else if (modSource == ModulationSidechain) dsp.keyInput.connect({silence.data(), silence.data()});
+  else dsp.keyInput.connect(io);
+  inputScope.push(io[0], io[1], n);
+  dsp.process(0, n);
+  analyzerFeed.push(n, [&](int signal, float *dest, int start, int count)
+  {
+   switch (signal)
+   {
+    case AnalyzerFeed::Input:
+     std::copy(io[0] + start, io[0] + start + count, dest);
+     break;
+     
+    case AnalyzerFeed::InPhase:
+     for (int i = 0; i < count; ++i) dest[i] = dsp.rotator.signalXIn(0, start + i);
+     break;
+     
+    case AnalyzerFeed::Quadrature:
+     for (int i = 0; i < count; ++i) dest[i] = dsp.rotator.signalYIn(0, start + i);
+     break;
+     
+    case AnalyzerFeed::OutputLeft:
+     for (int i = 0; i < count; ++i) dest[i] = dsp.bypassFade.signalOut.buffer(0, start + i);
+     break;
+     
+    case AnalyzerFeed::OutputRight:
+     for (int i = 0; i < count; ++i) dest[i] = dsp.bypassFade.signalOut.buffer(1, start + i);
+     break;
+   }
+  });
+  dsp.bypassFade.signalOut.fastTransfer<float>(io, n);
+  outputScope.push(io[0], io[1], n);
+  
+  if (sideOutputs)
+  {
+   auto transferSide = [&](auto &signal, const std::array<float*, 2> &dest)
+   {
+    if (dest[0] == nullptr) return;
+    signal.template fastTransfer<float>({dest[0] + offset, dest[1] ? dest[1] + offset : sidebuf.data()}, n);
+   };
+   transferSide(dsp.analytic.envelopeOut, side[0]);
+   transferSide(dsp.analytic.phaseOut, side[1]);
+   transferSide(dsp.analytic.frequencyOut, side[2]);
+  }
+ }
+}
+
+//==============================================================================
+bool PhaseRotatorAudioProcessor::hasEditor() const
+{
+ return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* PhaseRotatorAudioProcessor::createEditor()
+{
+ return new PhaseRotatorAudioProcessorEditor (*this, parameters);
+// return new juce::GenericAudioProcessorEditor(*this);
+}
+
+//==============================================================================
+void PhaseRotatorAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+ // The state is written as a list of parameter IDs and plain values, which avoids
+ // building a ValueTree and XML document on every save. Plain values stay put when a
+ // parameter's range or list of choices grows.
+ const juce::Array<juce::AudioProcessorParameter*> &list = getParameters();
+ juce::MemoryOutputStream stream(destData, false);
+ stream.writeInt(StateMagic);
+ stream.writeInt(StateVersion);
+ stream.writeCompressedInt(list.size());
+ for (auto *p : list)
+ {
+  auto *ranged = dynamic_cast<juce::RangedAudioParameter*>(p);
+  stream.writeString(ranged != nullptr ? ranged->paramID : juce::String());
+  stream.writeFloat(ranged != nullptr ? ranged->convertFrom0to1(p->getValue()) : p->getValue());
+ }
+}
+
+void PhaseRotatorAudioProcessor::getXmlStateInformation (juce::MemoryBlock& destData)
+{
+ auto p = parameters.copyState();
+ std::unique_ptr<juce::XmlElement> xml(p.createXml());
+ copyXmlToBinary(*xml, destData);
+}
+
+bool PhaseRotatorAudioProcessor::setBinaryState(const void* data, int sizeInBytes)
+{
+ juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+ if (sizeInBytes < 8 || stream.readInt() != StateMagic) return false;
+ 
+ // Chunks from a newer format version are left alone rather than misread
+ if (stream.readInt() > StateVersion) return true;
+ 
+ const int count = stream.readCompressedInt();
+ for (int i = 0; i < count && ! stream.isExhausted(); ++i)
+ {
+  const juce::String id = stream.readString();
+  float value = stream.readFloat();
+  
+  // For a while FIR Variable was a fifth mode rather than its own switch
+  if (id == "mode" && value >= ModesList.size())
+  {
+   if (auto *p = parameters.getParameter("variableFir")) p->setValueNotifyingHost(1.f);
+   value = static_cast<float>(ModesList.size() - 1);
+  }
+  if (auto *p = parameters.getParameter(id))
+  {
+   p->setValueNotifyingHost(p->convertTo0to1(value));
+  }
+ }
+ return true;
+}
+
+void PhaseRotatorAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+ if (setBinaryState(data, sizeInBytes)) return;
+ 
+ // Sessions saved before the binary format was added hold the parameter tree as XML
+ std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+ 
+ if (xmlState.get() != nullptr)
+ {
+  if (xmlState->hasTagName (parameters.state.getType()))
+  {
+   juce::ValueTree p = juce::ValueTree::fromXml(*xmlState);
+   parameters.replaceState(p);
+  }
+ }
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+ return new PhaseRotatorAudioProcessor();
+}
@@ -1,73 +1,172 @@
-/*
- ==============================================================================
- 
- This file contains the basic framework code for a JUCE plugin processor.
- 
- ==============================================================================
- */
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "PluginParameterListener.h"
-#include "DSP.h"
-
-//==============================================================================
-/**
- */
-class PhaseRotatorAudioProcessor  : public juce::AudioProcessor
-{
-public:
- //==============================================================================
- PhaseRotatorAudioProcessor();
- ~PhaseRotatorAudioProcessor() override;
- 
- //==============================================================================
- void prepareToPlay (double sampleRate, int samplesPerBlock) override;
- void releaseResources() override;
- 
-#ifndef JucePlugin_PreferredChannelConfigurations
- bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
-#endif
- 
- void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
- 
- //==============================================================================
- juce::AudioProcessorEditor* createEditor() override;
- bool hasEditor() const override;
- 
- //==============================================================================
- const juce::String getName() const override;
- 
- bool acceptsMidi() const override;
- bool producesMidi() const override;
- bool isMidiEffect() const override;
- double getTailLengthSeconds() const override;
- 
- //==============================================================================
- int getNumPrograms() override;
- int getCurrentProgram() override;
- void setCurrentProgram (int index) override;
- const juce::String getProgramName (int index) override;
- void changeProgramName (int index, const juce::String& newName) override;
- 
- //==============================================================================
- void getStateInformation (juce::MemoryBlock& destData) override;
- void setStateInformation (const void* data, int sizeInBytes) override;
- 
- XDDSP::Parameters dspParam;
- XDDSP::PhaseRotatorDSP dsp;
-
- juce::StringArray ModesList = {"IIR", "FIR 255", "FIR 1023", "FIR 2047"};
-
-private:
- //==============================================================================
- 
- std::vector<float> monobuf;
-
- juce::AudioProcessorValueTreeState parameters;
- std::unique_ptr<PluginParameterListener> rotationListen;
- std::unique_ptr<PluginParameterListener> modeListen;
-
- JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PhaseRotatorAudioProcessor)
-};
+/*
+ ==============================================================================
+ 
+ This file contains the basic framework code for a JUCE plugin processor.
+ 
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "PluginParameterListener.h"
+#include "DSP.h"
+#include "ScopeFeed.h"
+#include "Analyzer.h"
+
+//==============================================================================
+/**
+ */
+class PhaseRotatorAudioProcessor  : public juce::AudioProcessor, private juce::AsyncUpdater
+{
+public:
+ //==============================================================================
+ PhaseRotatorAudioProcessor();
+ ~PhaseRotatorAudioProcessor() override;
+ 
+ //==============================================================================
+ void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+ void releaseResources() override;
+ 
+#ifndef JucePlugin_PreferredChannelConfigurations
+ bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+#endif
+ 
+ void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+ void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+ juce::AudioProcessorParameter* getBypassParameter() const override;
+ 
+ //==============================================================================
+ juce::AudioProcessorEditor* createEditor() override;
+ bool hasEditor() const override;
+ 
+ //==============================================================================
+ const juce::String getName() const override;
+ 
+ bool acceptsMidi() const override;
+ bool producesMidi() const override;
+ bool isMidiEffect() const override;
+ double getTailLengthSeconds() const override;
+ 
+ //==============================================================================
+ int getNumPrograms() override;
+ int getCurrentProgram() override;
+ void setCurrentProgram (int index) override;
+ const juce::String getProgramName (int index) override;
+ void changeProgramName (int index, const juce::String& newName) override;
+ 
+ //==============================================================================
+ void getStateInformation (juce::MemoryBlock& destData) override;
+ void setStateInformation (const void* data, int sizeInBytes) override;
+ 
+ // Writes the state the way versions before the binary format did, as the parameter
+ // tree in XML. setStateInformation still reads it; the tests time the two formats.
+ void getXmlStateInformation (juce::MemoryBlock& destData);
+ 
+ XDDSP::Parameters dspParam;
+ XDDSP::PhaseRotatorDSP dsp;
+ 
+ typedef ScopeFeed<> Scope;
+ Scope inputScope;
+ Scope outputScope;
+ AnalyzerFeed analyzerFeed;
+ 
+ // Output buses for the analytic side outputs
+ enum SideOutputBuses
+ {
+  EnvelopeBus = 1,
+  PhaseBus,
+  FrequencyBus
+ };
+ 
+ // Set by the editor while it shows the envelope and frequency meters
+ std::atomic<bool> analyticMetersActive {false};
+
+ // The DSP graph is always run in sub-blocks of this many samples, regardless of the
+ // host buffer size. At 128 samples every intermediate stereo buffer is 2KB, so the
+ // whole graph stays resident in L1 between components. The size is fixed in the
+ // plugin; code using the engine through PhaseRotatorAPI.h chooses its own.
+ static constexpr int SubBlockSize = 128;
+ static constexpr int OfflineSubBlockSize = 1024;
+
+ // Hosts store automation of a choice as a normalised value, so adding a mode to this
+ // list would move existing automation onto a different mode. The variable length FIR
+ // has its own switch instead.
+ juce::StringArray ModesList = {"IIR", "FIR 255", "FIR 1023", "FIR 2047"};
+ 
+ enum StereoModes
+ {
+  StereoLinked = 0,
+  StereoIndependent,
+  StereoMidSide
+ };
+ 
+ juce::StringArray StereoModesList = {"Linked", "L/R", "Mid/Side"};
+ 
+ enum ModulationSources
+ {
+  ModulationOff = 0,
+  ModulationLFO,
+  ModulationLFOSync,
+  ModulationEnvelope,
+  ModulationSidechain
+ };
+ 
+ juce::StringArray ModSourcesList = {"Off", "LFO", "LFO Sync", "Envelope", "Sidechain"};
+ juce::StringArray DivisionsList = {"4 Bars", "2 Bars", "1 Bar", "1/2", "1/4", "1/8", "1/16"};
+
+private:
+ //==============================================================================
+ 
+ int preparedSubBlockSize {SubBlockSize};
+ std::vector<float> monobuf;
+ std::vector<float> sidebuf;
+ std::vector<float> silence;
+ 
+ void updateRotation();
+ void updateEngine();
+ void process(juce::AudioBuffer<float>& buffer, bool bypassed);
+ 
+ // Builds the kernel for the variable FIR mode, and allocates the high quality
+ // engine once it is wanted, off the audio thread. The audio thread takes them up.
+ void updateVariableKernel();
+ void handleAsyncUpdate() override;
+ 
+ // Restores a chunk written by getStateInformation, returning false if it isn't one
+ bool setBinaryState(const void* data, int sizeInBytes);
+ 
+ // The parameter listeners can run on any thread, so the settings that choose the
+ // engine are only stored there. The audio thread sees engineChanged and applies
+ // them in updateEngine.
+ std::atomic<int> mode {0};
+ std::atomic<bool> variableFir {false};
+ std::atomic<bool> offlineQuality {false};
+ std::atomic<bool> engineChanged {false};
+ bool renderingOffline {false};
+ 
+ float rotation {0.};
+ float rotation2 {0.};
+ int stereoMode {StereoLinked};
+ int modSource {ModulationOff};
+ float beatsPerCycle {4.};
+ bool bypass {false};
+ float lowFrequency {80.};
+
+ juce::AudioProcessorValueTreeState parameters;
+ std::unique_ptr<PluginParameterListener> rotationListen;
+ std::unique_ptr<PluginParameterListener> rotation2Listen;
+ std::unique_ptr<PluginParameterListener> stereoModeListen;
+ std::unique_ptr<PluginParameterListener> modeListen;
+ std::unique_ptr<PluginParameterListener> peakReductionListen;
+ std::unique_ptr<PluginParameterListener> offlineQualityListen;
+ std::unique_ptr<PluginParameterListener> modSourceListen;
+ std::unique_ptr<PluginParameterListener> modDepthListen;
+ std::unique_ptr<PluginParameterListener> modRateListen;
+ std::unique_ptr<PluginParameterListener> modDivisionListen;
+ std::unique_ptr<PluginParameterListener> bypassListen;
+ std::unique_ptr<PluginParameterListener> lowFrequencyListen;
+ std::unique_ptr<PluginParameterListener> variableFirListen;
+
+ JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PhaseRotatorAudioProcessor)
+};
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    ScopeFeed.h
+    Created: 19 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+
+
+
+
+
+
+
+
+
+// Carries a decimated picture of an audio signal from the audio thread to the GUI. The
+// audio thread reduces the signal to min/max bins at several resolutions at once, each
+// level merging LevelFactor bins of the level below, and pushes every finished bin into
+// a lock-free single producer, single consumer ring for its level. The GUI reads bins
+// from whichever level gives about one bin per pixel, so it never touches raw samples.
+template <int Levels = 4, int BaseDecimation = 8, int LevelFactor = 4, int RingSize = 2048>
+class ScopeFeed
+{
+public:
+ struct Bin
+ {
+  float minimum;
+  float maximum;
+ };
+ 
+private:
+ struct Level
+ {
+  juce::AbstractFifo fifo {RingSize};
+  std::vector<Bin> ring;
+  Bin accumulator {0.f, 0.f};
+  int count {0};
+ };
+ 
+ std::array<Level, Levels> levels;
+ std::atomic<bool> active {false};
+ 
+ void write(int l, const Bin &b)
+ {
+  Level &level = levels[l];
+  
+  // If the GUI has stopped reading then the bin is dropped
+  int start1, size1, start2, size2;
+  level.fifo.prepareToWrite(1, start1, size1, start2, size2);
+  if (size1 > 0) level.ring[start1] = b;
+  level.fifo.finishedWrite(size1);
+  
+  if (l + 1 < Levels) accumulate(l + 1, b);
+ }
+ 
+ void accumulate(int l, const Bin &b)
+ {
+  Level &level = levels[l];
+  if (level.count == 0) level.accumulator = b;
+  else
+  {
+   level.accumulator.minimum = std::min(level.accumulator.minimum, b.minimum);
+   level.accumulator.maximum = std::max(level.accumulator.maximum, b.maximum);
+  }
+  if (++level.count == LevelFactor)
+  {
+   level.count = 0;
+   write(l, level.accumulator);
+  }
+ }
+ 
+public:
+ static constexpr int LevelCount = Levels;
+ 
+ // Returns the number of samples summarised by one bin at the given level
+ static constexpr int samplesPerBin(int level)
+ {
+  int s = BaseDecimation;
+  for (int l = 0; l < level; ++l) s *= LevelFactor;
+  return s;
+ }
+ 
+ // The feed costs nothing on the audio thread while no display is reading it. The rings
+ // are allocated when a display first asks for them, so instances whose editor is never
+ // opened don't carry them, and are kept from then on because the audio thread may
+ // still be writing when the feed is switched off.
+ void setActive(bool shouldBeActive)
+ {
+  if (shouldBeActive && levels[0].ring.empty())
+  {
+   for (auto &l : levels) l.ring.resize(RingSize);
+  }
+  active.store(shouldBeActive, std::memory_order_release);
+ }
+ 
+ bool isActive() const
+ {
+  return active;
+ }
+ 
+ // Called from the audio thread. The two channels are averaged; pass the same pointer
+ // twice for a mono signal.
+ void push(const float *left, const float *right, int sampleCount)
+ {
+  if (!active.load(std::memory_order_acquire)) return;
+  
+  Level &base = levels[0];
+  for (int i = 0; i < sampleCount; ++i)
+  {
+   const float x = 0.5f*(left[i] + right[i]);
+   if (base.count == 0) base.accumulator = {x, x};
+   else
+   {
+    base.accumulator.minimum = std::min(base.accumulator.minimum, x);
+    base.accumulator.maximum = std::max(base.accumulator.maximum, x);
+   }
+   if (++base.count == BaseDecimation)
+   {
+    base.count = 0;
+    write(0, base.accumulator);
+   }
+  }
+ }
+ 
+ // Called from the GUI thread. Copies up to maximumBins of the oldest unread bins at
+ // the given level into dest and returns how many were copied. The other levels are
+ // not touched, so call discard on them to stop them filling up.
+ int pull(int level, Bin *dest, int maximumBins)
+ {
+  Level &l = levels[level];
+  int start1, size1, start2, size2;
+  l.fifo.prepareToRead(maximumBins, start1, size1, start2, size2);
+  std::copy(l.ring.begin() + start1, l.ring.begin() + start1 + size1, dest);
+  std::copy(l.ring.begin() + start2, l.ring.begin() + start2 + size2, dest + size1);
+  l.fifo.finishedRead(size1 + size2);
+  return size1 + size2;
+ }
+ 
+ // Called from the GUI thread. Throws away every unread bin at the given level.
+ void discard(int level)
+ {
+  Level &l = levels[level];
+  l.fifo.finishedRead(l.fifo.getNumReady());
+ }
+};
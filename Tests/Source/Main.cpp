@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 19 Oct 2026
+
+    Headless tests for the phase rotator. Run with no arguments for all of them,
+    or name one:
+
+      regression [--record] [--require-golden] [--golden <folder>]
+      state [--instances <count>]
+      stress [--instances <count>] [--threads <count>] [--mode <mode>]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "RegressionTests.h"
+#include "StateBenchmark.h"
+#include "StressTest.h"
+
+// The stored outputs are kept in Tests/Golden unless another folder is given. Every
+// exporter builds the executable somewhere inside the Tests folder, so it is found by
+// looking up from the executable for the project file. Returns a default File if it
+// can't be found.
+static juce::File defaultGoldenFolder()
+{
+ auto folder = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+ for (; !folder.isRoot(); folder = folder.getParentDirectory())
+ {
+  if (folder.getChildFile("PhaseRotatorTests.jucer").existsAsFile()) return folder.getChildFile("Golden");
+ }
+ return {};
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+ // The plugin instances need a message manager, but never open a window
+ juce::ScopedJuceInitialiser_GUI juceInitialiser;
+ juce::ArgumentList args(argc, argv);
+ const juce::String command = (args.size() > 0 && !args[0].isOption()) ? args[0].text : juce::String();
+
+ juce::File goldenFolder = defaultGoldenFolder();
+ if (args.containsOption("--golden")) goldenFolder = args.getFileForOption("--golden");
+
+ bool passed = true;
+ if (command.isEmpty() || command == "regression")
+ {
+  if (goldenFolder == juce::File())
+  {
+   std::cout << "Can't find the Tests folder from the executable, so give the stored outputs with --golden <folder>" << std::endl;
+   passed = false;
+  }
+  else
+  {
+   std::cout << "Regression against an ideal rotator and " << goldenFolder.getFullPathName() << std::endl;
+   passed = RegressionTests::run(goldenFolder, args.containsOption("--record"), args.containsOption("--require-golden")) && passed;
+  }
+ }
+
+ if (command.isEmpty() || command == "state")
+ {
+  const int instances = args.containsOption("--instances")
+  ? args.getValueForOption("--instances").getIntValue() : StateBenchmark::DefaultInstances;
+  std::cout << "State save and load" << std::endl;
+  passed = StateBenchmark::run(std::max(1, instances)) && passed;
+ }
+
+ // The stress test takes a while, so it only runs when asked for
+ if (command == "stress")
+ {
+  const int instances = args.containsOption("--instances")
+  ? args.getValueForOption("--instances").getIntValue() : StressTest::DefaultInstances;
+  const int threads = args.containsOption("--threads")
+  ? args.getValueForOption("--threads").getIntValue() : StressTest::DefaultThreads;
+  const int mode = args.containsOption("--mode")
+  ? args.getValueForOption("--mode").getIntValue() : StressTest::DefaultMode;
+  std::cout << "Many instances" << std::endl;
+  passed = StressTest::run(std::max(1, instances), std::max(1, threads), juce::jlimit(0, static_cast<int>(XDDSP::PhaseRotatorDSP::VariableMode), mode)) && passed;
+ }
+
+ std::cout << (passed ? "All tests passed" : "Some tests failed") << std::endl;
+ return passed ? 0 : 1;
+}
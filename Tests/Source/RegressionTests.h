@@ -0,0 +1,574 @@
+/*
+  ==============================================================================
+
+    RegressionTests.h
+    Created: 19 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/DSP.h"
+#include <array>
+#include <complex>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+
+
+
+
+
+
+
+
+
+// Drives PhaseRotatorDSP directly, without the plugin around it, with an impulse, a
+// sweep and a noise burst in every mode. Each output is checked two ways.
+//
+// Against an ideal Hilbert rotator: at the test rotation the response should have
+// unity gain, and its phase should be turned from the response at rotation zero by
+// exactly the test rotation at every positive frequency. The FIR modes should also
+// have exactly their reported latency. The magnitude and phase errors are reported
+// for each octave band, over the part of it where the filter is designed to be
+// accurate.
+//
+// Against stored output: the output at a fixed rotation must match what was recorded
+// in the Golden folder, so that any rewrite of the filters or the rotator that changes
+// the sound shows up, even if it stays within the ideal tolerances.
+//
+// The kernels this repository designs are also compared with XDDSP's filters of the
+// same lengths, which the fixed length FIR modes use. They must have the same in phase
+// delay and the same quadrature sign, and the difference in their quadrature
+// responses, which is the difference in sound between those modes and the variable
+// and offline modes, is reported for each octave band.
+namespace RegressionTests
+{
+ constexpr double SampleRate = 48000.;
+ constexpr int BlockSize = 128;
+
+ // The test signals are SignalLength samples long, followed by silence so that every
+ // mode's output has died away well within Length samples. The analysis then sees the
+ // whole response, and the spectrum of the output is exactly the spectrum of the input
+ // times the response.
+ constexpr int FFTOrder = 14;
+ constexpr int Length = 1 << FFTOrder;
+ constexpr int SignalLength = 4096;
+ constexpr int StoredLength = 8192;
+ constexpr double StoredTolerance = 1e-5;
+
+ constexpr double TestRotation = 60.;
+
+ // A Blackman windowed kernel of length N keeps its quadrature gain within 0.1% of
+ // unity from about 2.6 fs/N up to the same distance below Nyquist. Its in-phase path
+ // is an exact delay, and being antisymmetric, its quadrature path is exactly a
+ // quarter turn from that. At the test rotation the gain can then only stray by as
+ // much as the quadrature gain, 0.1% or 0.009dB, and the rotation by no more than
+ // sin(2 angle)/2 times that in radians, 0.025 degrees. The tolerances leave a little
+ // room on top for the float output.
+ constexpr double MagnitudeTolerance = 0.01;
+ constexpr double PhaseTolerance = 0.05;
+
+ inline double firLowest(int length) { return 2.6*SampleRate/length; }
+ inline double firHighest(int length) { return 0.5*SampleRate - 2.6*SampleRate/length; }
+
+ struct ModeCase
+ {
+  const char *name;
+  const char *fileName;
+  int mode;
+
+  // For the variable FIR mode, the lowest frequency it is set up for
+  double variableFrequency;
+
+  // The band over which the errors are measured
+  double lowest;
+  double highest;
+
+  // Whether the errors are held to the tolerances above. The IIR approximator and the
+  // fixed length FIR filters are designed in XDDSP, which doesn't state how accurate
+  // they are, so there is nothing to hold them to. Their errors are only reported, and
+  // their stored output is what guards their sound.
+  bool checked;
+
+  // Whether the mode is linear phase with its reported latency
+  bool linearPhase;
+ };
+
+ inline std::vector<ModeCase> modeCases()
+ {
+  using D = XDDSP::PhaseRotatorDSP;
+  const int variableLength = decltype(D::fVariable)::lengthForFrequency(SampleRate, 80.);
+  return
+  {
+   {"IIR", "iir", 0, 0., 20., 20000., false, false},
+   {"FIR 255", "fir255", 1, 0., firLowest(255), firHighest(255), false, true},
+   {"FIR 1023", "fir1023", 2, 0., firLowest(1023), firHighest(1023), false, true},
+   {"FIR 2047", "fir2047", 3, 0., firLowest(2047), firHighest(2047), false, true},
+   {"FIR Variable", "firvariable", D::VariableMode, 80., firLowest(variableLength), firHighest(variableLength), true, true},
+   {"HQ Offline", "hq", D::HighQualityMode, 0., firLowest(4095), firHighest(4095), true, true}
+  };
+ }
+
+
+
+
+
+
+
+
+
+
+ // The test signals are generated the same way on every platform
+ enum Signals
+ {
+  Impulse = 0,
+  Sweep,
+  Noise,
+  SignalCount
+ };
+
+ inline const char *signalName(int s)
+ {
+  static const char *names[] = {"impulse", "sweep", "noise"};
+  return names[s];
+ }
+
+ inline std::vector<float> makeSignal(int s)
+ {
+  std::vector<float> x(Length, 0.f);
+  switch (s)
+  {
+   case Impulse:
+   default:
+    x[0] = 0.5f;
+    break;
+
+   case Sweep:
+   {
+    // Exponential sine sweep from 20Hz to 20kHz
+    const double f0 = 20., f1 = 20000.;
+    const double k = SignalLength/log(f1/f0);
+    for (int i = 0; i < SignalLength; ++i)
+    {
+     const double phase = 2.*M_PI*f0*k/SampleRate*(exp(i/k) - 1.);
+     x[i] = static_cast<float>(0.5*sin(phase));
+    }
+    break;
+   }
+
+   case Noise:
+   {
+    uint32_t state = 12345;
+    for (int i = 0; i < SignalLength; ++i)
+    {
+     state = state*1664525u + 1013904223u;
+     x[i] = static_cast<float>(state >> 8)/16777216.f - 0.5f;
+    }
+    break;
+   }
+  }
+
+  // Short raised cosine fades, so the bursts have no hard edges
+  if (s != Impulse)
+  {
+   const int fade = 64;
+   for (int i = 0; i < fade; ++i)
+   {
+    const float g = static_cast<float>(0.5 - 0.5*cos(M_PI*i/fade));
+    x[i] *= g;
+    x[SignalLength - 1 - i] *= g;
+   }
+  }
+  return x;
+ }
+
+
+
+
+
+
+
+
+
+
+ // Makes a fresh engine in the given mode, with no compensation delay
+ inline std::unique_ptr<XDDSP::PhaseRotatorDSP> makeEngine(XDDSP::Parameters &p, const ModeCase &m)
+ {
+  p.setSampleRate(SampleRate);
+  p.setBufferSize(BlockSize);
+  auto dsp = std::make_unique<XDDSP::PhaseRotatorDSP>(p);
+  dsp->allocateHighQuality();
+  if (m.variableFrequency > 0.)
+  {
+   dsp->fVariable.setLength(dsp->fVariable.lengthForFrequency(SampleRate, m.variableFrequency));
+   dsp->fVariable.updateKernel();
+  }
+  dsp->setMode(m.mode);
+  dsp->setCompensationDelay(0);
+  return dsp;
+ }
+
+ // Runs a signal through a fresh engine, with both channels fed the same signal, and
+ // returns the left output. Returns an empty vector if the right output differs from
+ // the left.
+ inline std::vector<float> render(const ModeCase &m, const std::vector<float> &input, double degrees)
+ {
+  XDDSP::Parameters p;
+  auto dsp = makeEngine(p, m);
+  dsp->manualRotation.setControl(degrees/180.*M_PI);
+  dsp->manualRotation.snap();
+
+  std::vector<float> left(input), right(input);
+  for (int offset = 0; offset < Length; offset += BlockSize)
+  {
+   const int n = std::min(BlockSize, Length - offset);
+   std::array<float*, 2> io {left.data() + offset, right.data() + offset};
+   dsp->floatInput.connect(io);
+   dsp->keyInput.connect(io);
+   dsp->process(0, n);
+   dsp->bypassFade.signalOut.fastTransfer<float>(io, n);
+  }
+
+  if (left != right) return {};
+  return left;
+ }
+
+ inline std::vector<std::complex<double>> spectrum(const std::vector<float> &x)
+ {
+  juce::dsp::FFT fft(FFTOrder);
+  std::vector<juce::dsp::Complex<float>> in(Length), out(Length);
+  for (int i = 0; i < Length; ++i) in[i] = x[i];
+  fft.perform(in.data(), out.data(), false);
+  std::vector<std::complex<double>> result(Length);
+  for (int i = 0; i < Length; ++i) result[i] = out[i];
+  return result;
+ }
+
+
+
+
+
+
+
+
+
+
+ // The errors in one octave band, or in all of them. Magnitude errors are in dB and
+ // phase errors in degrees.
+ struct Errors
+ {
+  double centre {0.};
+  int bins {0};
+  double magnitude {0.};
+  double rotation {0.};
+  double latency {0.};
+
+  void include(const Errors &e)
+  {
+   bins += e.bins;
+   magnitude = std::max(magnitude, e.magnitude);
+   rotation = std::max(rotation, e.rotation);
+   latency = std::max(latency, e.latency);
+  }
+
+  bool within() const
+  {
+   return magnitude <= MagnitudeTolerance && rotation <= PhaseTolerance && latency <= PhaseTolerance;
+  }
+ };
+
+ // Octave bands, named by their nominal centre frequencies
+ constexpr std::array<double, 10> BandCentres {31.5, 63., 125., 250., 500., 1000., 2000., 4000., 8000., 16000.};
+
+ inline double degrees(std::complex<double> z)
+ {
+  return std::abs(std::arg(z))*180./M_PI;
+ }
+
+ // Compares the measured responses at rotation 0 and at the test rotation with an
+ // ideal rotator in each octave band, over the bins in the mode's band where the input
+ // has energy. Bands with no such bins are left out.
+ inline std::vector<Errors> measure(const ModeCase &m, int latency,
+                                    const std::vector<float> &input,
+                                    const std::vector<float> &unrotated,
+                                    const std::vector<float> &rotated)
+ {
+  const auto x = spectrum(input);
+  const auto y0 = spectrum(unrotated);
+  const auto y1 = spectrum(rotated);
+
+  double peak = 0.;
+  for (int k = 1; k < Length/2; ++k) peak = std::max(peak, std::abs(x[k]));
+
+  // The quadrature signal leads the in phase signal by a quarter turn, so the rotation
+  // advances the phase at every positive frequency
+  const std::complex<double> turn = std::polar(1., TestRotation/180.*M_PI);
+  std::vector<Errors> bands;
+  for (double centre : BandCentres)
+  {
+   Errors e;
+   e.centre = centre;
+   const double low = std::max(m.lowest, centre/M_SQRT2);
+   const double high = std::min(m.highest, centre*M_SQRT2);
+   for (int k = 1; k < Length/2; ++k)
+   {
+    const double f = k*SampleRate/Length;
+    if (f < low || f >= high || std::abs(x[k]) < 1e-3*peak) continue;
+
+    const std::complex<double> h0 = y0[k]/x[k];
+    const std::complex<double> h1 = y1[k]/x[k];
+    ++e.bins;
+    e.magnitude = std::max(e.magnitude, std::fabs(20.*log10(std::abs(h1))));
+    e.rotation = std::max(e.rotation, degrees(h1/(turn*h0)));
+    if (m.linearPhase)
+    {
+     const std::complex<double> delay = std::polar(1., -2.*M_PI*f/SampleRate*latency);
+     e.latency = std::max(e.latency, degrees(h0/delay));
+    }
+   }
+   if (e.bins > 0) bands.push_back(e);
+  }
+  return bands;
+ }
+
+ inline juce::String describe(const ModeCase &m, const Errors &e)
+ {
+  juce::String s;
+  s << "gain " << juce::String(e.magnitude, 4) << "dB  rotation " << juce::String(e.rotation, 4) << "deg";
+  if (m.linearPhase) s << "  latency " << juce::String(e.latency, 4) << "deg";
+  return s;
+ }
+
+
+
+
+
+
+
+
+
+
+ // Runs an impulse through a Hilbert filter and returns the in phase and quadrature
+ // outputs of the left channel
+ template <typename Filter, typename Prepare>
+ void impulseResponse(std::vector<float> &inPhase, std::vector<float> &quadrature, Prepare prepare)
+ {
+  XDDSP::Parameters p;
+  p.setSampleRate(SampleRate);
+  p.setBufferSize(BlockSize);
+  XDDSP::BufferCoupler<float, 2> input;
+  auto filter = std::make_unique<Filter>(p, input);
+  prepare(*filter);
+
+  std::vector<float> left = makeSignal(Impulse);
+  std::vector<float> right(left);
+  inPhase.assign(Length, 0.f);
+  quadrature.assign(Length, 0.f);
+  for (int offset = 0; offset < Length; offset += BlockSize)
+  {
+   const int n = std::min(BlockSize, Length - offset);
+   input.connect({left.data() + offset, right.data() + offset});
+   filter->process(0, n);
+   for (int i = 0; i < n; ++i)
+   {
+    inPhase[offset + i] = static_cast<float>(filter->inPhaseOut.buffer(0, i));
+    quadrature[offset + i] = static_cast<float>(filter->quadratureOut.buffer(0, i));
+   }
+  }
+ }
+
+ // Compares this repository's kernel of length N with XDDSP's filter of the same
+ // length, over the band where the kernel is designed to be accurate. Prints the
+ // difference in the quadrature response for each octave band. Returns false if the
+ // in phase delay or the quadrature sign differ.
+ template <int N>
+ bool compareKernel()
+ {
+  std::vector<float> oldInPhase, oldQuadrature, newInPhase, newQuadrature;
+  impulseResponse<XDDSP::ConvolutionHilbertFilter<XDDSP::Connector<2>, N>>(oldInPhase, oldQuadrature, [](auto &) {});
+  impulseResponse<XDDSP::FIRHilbertFilter<XDDSP::Connector<2>, N>>(newInPhase, newQuadrature, [](auto &f) { f.allocate(); });
+
+  double inPhaseDifference = 0.;
+  for (int i = 0; i < Length; ++i)
+  {
+   inPhaseDifference = std::max(inPhaseDifference, std::fabs(static_cast<double>(newInPhase[i]) - oldInPhase[i]));
+  }
+
+  const auto q0 = spectrum(oldQuadrature);
+  const auto q1 = spectrum(newQuadrature);
+  bool sameSign = true;
+  double worstMagnitude = 0.;
+  double worstPhase = 0.;
+  juce::String bands;
+  for (double centre : BandCentres)
+  {
+   const double low = std::max(firLowest(N), centre/M_SQRT2);
+   const double high = std::min(firHighest(N), centre*M_SQRT2);
+   double magnitude = 0.;
+   double phase = 0.;
+   int bins = 0;
+   for (int k = 1; k < Length/2; ++k)
+   {
+    const double f = k*SampleRate/Length;
+    if (f < low || f >= high) continue;
+    const std::complex<double> ratio = q1[k]/q0[k];
+    magnitude = std::max(magnitude, std::fabs(20.*log10(std::abs(ratio))));
+    phase = std::max(phase, degrees(ratio));
+    ++bins;
+   }
+   if (bins == 0) continue;
+   sameSign = sameSign && phase < 90.;
+   worstMagnitude = std::max(worstMagnitude, magnitude);
+   worstPhase = std::max(worstPhase, phase);
+   bands << "    " << (juce::String(centre, centre < 50. ? 1 : 0) + "Hz").paddedRight(' ', 10)
+   << "quadrature " << juce::String(magnitude, 4) << "dB " << juce::String(phase, 4) << "deg\n";
+  }
+
+  const bool ok = inPhaseDifference <= 1e-7 && sameSign;
+  std::cout << (juce::String("FIR ") + juce::String(N)).paddedRight(' ', 10)
+  << "in phase " << juce::String(inPhaseDifference, 7)
+  << "  quadrature " << juce::String(worstMagnitude, 4) << "dB " << juce::String(worstPhase, 4) << "deg"
+  << (ok ? "  ok" : "  FAIL: the delay or the sign differs") << std::endl << bands;
+  return ok;
+ }
+
+ inline bool compareKernels()
+ {
+  std::cout << "Kernels against XDDSP's ConvolutionHilbertFilter" << std::endl;
+  bool passed = compareKernel<255>();
+  passed = compareKernel<1023>() && passed;
+  passed = compareKernel<2047>() && passed;
+  return passed;
+ }
+
+
+
+
+
+
+
+
+
+
+ // Writes the first StoredLength samples of an output as little endian floats
+ inline bool store(const juce::File &file, const std::vector<float> &y)
+ {
+  file.getParentDirectory().createDirectory();
+  file.deleteFile();
+  juce::FileOutputStream stream(file);
+  if (stream.failedToOpen()) return false;
+  for (int i = 0; i < StoredLength; ++i) stream.writeFloat(y[i]);
+  return true;
+ }
+
+ // Returns the largest difference from a stored output, or a negative number if there
+ // is no stored output to compare with
+ inline double compare(const juce::File &file, const std::vector<float> &y)
+ {
+  if (file.getSize() != StoredLength*static_cast<juce::int64>(sizeof(float))) return -1.;
+  juce::FileInputStream stream(file);
+  if (stream.failedToOpen()) return -1.;
+  double difference = 0.;
+  for (int i = 0; i < StoredLength; ++i)
+  {
+   difference = std::max(difference, std::fabs(static_cast<double>(stream.readFloat()) - y[i]));
+  }
+  return difference;
+ }
+
+
+
+
+
+
+
+
+
+
+ // Runs every case and prints a line for each, with the errors in each octave band
+ // for the impulse, which has energy in every band. With record set, the stored
+ // outputs are written instead of compared. A stored output that is missing only
+ // fails when requireStored is set. Returns true if every check passed.
+ inline bool run(const juce::File &goldenFolder, bool record, bool requireStored)
+ {
+  bool passed = true;
+  int missing = 0;
+  for (const ModeCase &m : modeCases())
+  {
+   for (int s = 0; s < SignalCount; ++s)
+   {
+    const std::vector<float> input = makeSignal(s);
+    const std::vector<float> unrotated = render(m, input, 0.);
+    const std::vector<float> rotated = render(m, input, TestRotation);
+
+    juce::String line = juce::String(m.name).paddedRight(' ', 14) + juce::String(signalName(s)).paddedRight(' ', 9);
+    if (unrotated.empty() || rotated.empty())
+    {
+     std::cout << line << "FAIL: the channels differ" << std::endl;
+     passed = false;
+     continue;
+    }
+
+    XDDSP::Parameters p;
+    const int latency = makeEngine(p, m)->getModeLatency(m.mode);
+    const std::vector<Errors> bands = measure(m, latency, input, unrotated, rotated);
+    Errors worst;
+    for (const Errors &e : bands) worst.include(e);
+    bool ok = !m.checked || worst.within();
+    line << describe(m, worst);
+    if (!m.checked) line << "  (reported only)";
+
+    const juce::File file = goldenFolder.getChildFile(juce::String(m.fileName) + "_" + signalName(s) + ".f32");
+    if (record)
+    {
+     if (store(file, rotated)) line << "  recorded";
+     else
+     {
+      line << "  could not write " << file.getFullPathName();
+      ok = false;
+     }
+    }
+    else
+    {
+     const double difference = compare(file, rotated);
+     if (difference < 0.)
+     {
+      line << "  not recorded";
+      ++missing;
+      if (requireStored) ok = false;
+     }
+     else
+     {
+      line << "  stored " << juce::String(difference, 7);
+      ok = ok && difference <= StoredTolerance;
+     }
+    }
+
+    std::cout << line << (ok ? "  ok" : "  FAIL") << std::endl;
+    passed = passed && ok;
+
+    if (s == Impulse)
+    {
+     for (const Errors &e : bands)
+     {
+      std::cout << "    " << (juce::String(e.centre, e.centre < 50. ? 1 : 0) + "Hz").paddedRight(' ', 10)
+      << describe(m, e) << ((m.checked && !e.within()) ? "  FAIL" : "") << std::endl;
+     }
+    }
+   }
+  }
+
+  passed = compareKernels() && passed;
+
+  if (missing > 0)
+  {
+   std::cout << missing << " outputs have not been recorded in " << goldenFolder.getFullPathName()
+   << ". Run regression --record on a build that is known to be good, and commit them." << std::endl;
+  }
+  return passed;
+ }
+}
@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    StateBenchmark.h
+    Created: 19 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include <iostream>
+#include <memory>
+#include <vector>
+
+
+
+
+
+
+
+
+
+
+// Saves and loads the state of a session's worth of plugin instances, in the binary
+// format and in the XML format written by earlier versions, and reports how long each
+// takes. Every instance is given different settings, and the restored settings must
+// match the saved ones in both formats.
+namespace StateBenchmark
+{
+ constexpr int DefaultInstances = 500;
+ constexpr int Passes = 10;
+
+ // Gives every parameter of an instance a different setting
+ inline void scramble(juce::AudioProcessor &processor, juce::Random &random)
+ {
+  for (auto *p : processor.getParameters()) p->setValueNotifyingHost(random.nextFloat());
+ }
+
+ // Returns the number of parameters that differ between two instances
+ inline int countDifferences(juce::AudioProcessor &a, juce::AudioProcessor &b)
+ {
+  const auto &listA = a.getParameters();
+  const auto &listB = b.getParameters();
+  int differences = 0;
+  for (int i = 0; i < listA.size(); ++i)
+  {
+   if (std::fabs(listA[i]->getValue() - listB[i]->getValue()) > 1e-6f) ++differences;
+  }
+  return differences;
+ }
+
+ struct Timing
+ {
+  double save {0.};
+  double load {0.};
+  size_t bytes {0};
+ };
+
+ // Saves every source instance and restores it into the matching target instance,
+ // Passes times over, and returns the best time for each. Counts the parameters that
+ // didn't survive the round trip into differences.
+ template <typename Save>
+ Timing measure(std::vector<std::unique_ptr<PhaseRotatorAudioProcessor>> &sources,
+                std::vector<std::unique_ptr<PhaseRotatorAudioProcessor>> &targets,
+                Save save, int &differences)
+ {
+  const size_t count = sources.size();
+  std::vector<juce::MemoryBlock> chunks(count);
+  Timing best {1e30, 1e30, 0};
+  for (int pass = 0; pass < Passes; ++pass)
+  {
+   double start = juce::Time::getMillisecondCounterHiRes();
+   for (size_t i = 0; i < count; ++i)
+   {
+    chunks[i].reset();
+    save(*sources[i], chunks[i]);
+   }
+   best.save = std::min(best.save, juce::Time::getMillisecondCounterHiRes() - start);
+
+   start = juce::Time::getMillisecondCounterHiRes();
+   for (size_t i = 0; i < count; ++i)
+   {
+    targets[i]->setStateInformation(chunks[i].getData(), static_cast<int>(chunks[i].getSize()));
+   }
+   best.load = std::min(best.load, juce::Time::getMillisecondCounterHiRes() - start);
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+   best.bytes += chunks[i].getSize();
+   differences += countDifferences(*sources[i], *targets[i]);
+  }
+  return best;
+ }
+
+ inline void report(const char *name, const Timing &t, size_t count)
+ {
+  std::cout << juce::String(name).paddedRight(' ', 8)
+  << "save " << juce::String(t.save, 2) << " ms"
+  << "  load " << juce::String(t.load, 2) << " ms"
+  << "  per instance " << juce::String(1000.*(t.save + t.load)/count, 1) << " us"
+  << "  " << t.bytes/count << " bytes each" << std::endl;
+ }
+
+
+
+
+
+
+
+
+
+
+ // Returns true if the settings of every instance survived both formats
+ inline bool run(int instances)
+ {
+  std::vector<std::unique_ptr<PhaseRotatorAudioProcessor>> sources, targets;
+  juce::Random random(1);
+  for (int i = 0; i < instances; ++i)
+  {
+   sources.push_back(std::make_unique<PhaseRotatorAudioProcessor>());
+   targets.push_back(std::make_unique<PhaseRotatorAudioProcessor>());
+   scramble(*sources.back(), random);
+  }
+
+  int binaryDifferences = 0;
+  int xmlDifferences = 0;
+  const Timing binary = measure(sources, targets,
+                                [](juce::AudioProcessor &p, juce::MemoryBlock &m) { p.getStateInformation(m); },
+                                binaryDifferences);
+
+  // Scramble the targets again, so the XML pass has to restore every setting too
+  for (auto &t : targets) scramble(*t, random);
+  const Timing xml = measure(sources, targets,
+                             [](PhaseRotatorAudioProcessor &p, juce::MemoryBlock &m) { p.getXmlStateInformation(m); },
+                             xmlDifferences);
+
+  std::cout << instances << " instances, best of " << Passes << " passes" << std::endl;
+  report("Binary", binary, sources.size());
+  report("XML", xml, sources.size());
+  std::cout << "Binary is " << juce::String((xml.save + xml.load)/std::max(1e-9, binary.save + binary.load), 1)
+  << " times as fast as XML" << std::endl;
+
+  bool passed = true;
+  if (binaryDifferences > 0)
+  {
+   std::cout << "FAIL: " << binaryDifferences << " settings were lost in the binary format" << std::endl;
+   passed = false;
+  }
+  if (xmlDifferences > 0)
+  {
+   std::cout << "FAIL: " << xmlDifferences << " settings were lost in the XML format" << std::endl;
+   passed = false;
+  }
+  return passed;
+ }
+}
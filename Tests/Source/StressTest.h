@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    StressTest.h
+    Created: 19 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include <cmath>
+#include <condition_variable>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if JUCE_MAC
+#include <mach/mach.h>
+#elif JUCE_LINUX
+#include <unistd.h>
+#endif
+
+
+
+
+
+
+
+
+
+
+// Runs many plugin instances in one process, the way a host runs a big session: every
+// instance processes each block before the next block starts, spread over one or more
+// threads. The number of instances doubles from one up to the count asked for, and for
+// each count it reports the memory taken per instance, the wall and CPU time, the CPU
+// load as a share of one core running in real time, and the time per instance per
+// block relative to a single instance. Growth in that last figure is the cost of the
+// instances competing for the cache.
+namespace StressTest
+{
+ constexpr int DefaultInstances = 200;
+ constexpr int DefaultThreads = 1;
+ constexpr int DefaultMode = 2;
+ constexpr double SampleRate = 48000.;
+ constexpr int BlockSize = 512;
+ constexpr double AudioSeconds = 2.;
+
+ // Returns the resident memory of the whole process in bytes, or zero where it isn't
+ // known
+ inline size_t residentBytes()
+ {
+ #if JUCE_MAC
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) return 0;
+  return info.resident_size;
+ #elif JUCE_LINUX
+  long pages = 0, resident = 0;
+  if (FILE *f = fopen("/proc/self/statm", "r"))
+  {
+   if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+   fclose(f);
+  }
+  return static_cast<size_t>(resident)*static_cast<size_t>(sysconf(_SC_PAGESIZE));
+ #else
+  return 0;
+ #endif
+ }
+
+ struct Instance
+ {
+  std::unique_ptr<PhaseRotatorAudioProcessor> processor;
+  juce::AudioBuffer<float> buffer;
+  juce::MidiBuffer midi;
+ };
+
+ inline std::unique_ptr<Instance> makeInstance(int mode, juce::Random &random)
+ {
+  auto i = std::make_unique<Instance>();
+  i->processor = std::make_unique<PhaseRotatorAudioProcessor>();
+  auto &p = *i->processor;
+  for (auto *parameter : p.getParameters())
+  {
+   auto *ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+   if (ranged != nullptr && ranged->paramID == "mode")
+   {
+    ranged->setValueNotifyingHost(ranged->convertTo0to1(static_cast<float>(std::min(mode, p.ModesList.size() - 1))));
+   }
+   if (ranged != nullptr && ranged->paramID == "variableFir")
+   {
+    ranged->setValueNotifyingHost(mode == XDDSP::PhaseRotatorDSP::VariableMode ? 1.f : 0.f);
+   }
+  }
+  p.setRateAndBufferSizeDetails(SampleRate, BlockSize);
+  p.prepareToPlay(SampleRate, BlockSize);
+  i->buffer.setSize(std::max(p.getTotalNumInputChannels(), p.getTotalNumOutputChannels()), BlockSize);
+  i->buffer.clear();
+  for (int c = 0; c < p.getTotalNumInputChannels(); ++c)
+  {
+   for (int n = 0; n < BlockSize; ++n) i->buffer.setSample(c, n, 0.5f*random.nextFloat() - 0.25f);
+  }
+  return i;
+ }
+
+ // Holds each thread until every thread has finished the block, as a host waits for
+ // the whole graph before starting the next block
+ class BlockBarrier
+ {
+  std::mutex lock;
+  std::condition_variable released;
+  const int threadCount;
+  int waiting {0};
+  int generation {0};
+
+ public:
+  explicit BlockBarrier(int threads) : threadCount(threads) {}
+
+  void arriveAndWait()
+  {
+   std::unique_lock<std::mutex> guard(lock);
+   const int arrivedIn = generation;
+   if (++waiting == threadCount)
+   {
+    waiting = 0;
+    ++generation;
+    released.notify_all();
+    return;
+   }
+   released.wait(guard, [&]() { return generation != arrivedIn; });
+  }
+ };
+
+ // Processes blockCount blocks on every instance. Instance i runs on thread
+ // i % threadCount, and each thread takes its instances in turn for every block. No
+ // thread starts a block until every thread has finished the one before.
+ inline void processAll(std::vector<std::unique_ptr<Instance>> &instances, int threadCount, int blockCount)
+ {
+  BlockBarrier barrier(threadCount);
+  auto work = [&](int t)
+  {
+   for (int b = 0; b < blockCount; ++b)
+   {
+    for (size_t i = static_cast<size_t>(t); i < instances.size(); i += static_cast<size_t>(threadCount))
+    {
+     instances[i]->processor->processBlock(instances[i]->buffer, instances[i]->midi);
+    }
+    if (threadCount > 1) barrier.arriveAndWait();
+   }
+  };
+
+  if (threadCount == 1)
+  {
+   work(0);
+   return;
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t) threads.emplace_back(work, t);
+  for (auto &t : threads) t.join();
+ }
+
+ inline bool outputsFinite(std::vector<std::unique_ptr<Instance>> &instances)
+ {
+  for (auto &i : instances)
+  {
+   for (int c = 0; c < i->buffer.getNumChannels(); ++c)
+   {
+    const float *x = i->buffer.getReadPointer(c);
+    for (int n = 0; n < BlockSize; ++n) if (!std::isfinite(x[n])) return false;
+   }
+  }
+  return true;
+ }
+
+
+
+
+
+
+
+
+
+
+ // Returns false if any instance produced a value that isn't finite
+ inline bool run(int maximumInstances, int threadCount, int mode)
+ {
+  const int blockCount = static_cast<int>(AudioSeconds*SampleRate/BlockSize);
+  std::cout << "Mode " << mode << ", " << BlockSize << " sample blocks at " << SampleRate
+  << "Hz, " << AudioSeconds << "s of audio, " << threadCount << " thread(s)" << std::endl;
+  std::cout << "Instances  Memory each  Wall ms    CPU ms     CPU load   us/block  vs one" << std::endl;
+
+  juce::Random random(1);
+  std::vector<std::unique_ptr<Instance>> instances;
+  const size_t baseline = residentBytes();
+  double singleBlockTime = 0.;
+  bool passed = true;
+
+  for (int count = 1; ; count = std::min(2*count, maximumInstances))
+  {
+   while (static_cast<int>(instances.size()) < count) instances.push_back(makeInstance(mode, random));
+
+   // One short warm up, so that every buffer has been touched before the memory is read
+   processAll(instances, threadCount, 2);
+   const size_t resident = residentBytes();
+
+   const double wallStart = juce::Time::getMillisecondCounterHiRes();
+   const std::clock_t cpuStart = std::clock();
+   processAll(instances, threadCount, blockCount);
+   const double cpu = 1000.*static_cast<double>(std::clock() - cpuStart)/CLOCKS_PER_SEC;
+   const double wall = juce::Time::getMillisecondCounterHiRes() - wallStart;
+
+   // The time each instance spends on one block, counting all threads
+   const double blockTime = 1000.*cpu/(static_cast<double>(count)*blockCount);
+   if (count == 1) singleBlockTime = blockTime;
+
+   std::cout << juce::String(count).paddedRight(' ', 11)
+   << (juce::String(resident > baseline ? (resident - baseline)/(1024.*count) : 0., 1) + " KB").paddedRight(' ', 13)
+   << juce::String(wall, 1).paddedRight(' ', 11)
+   << juce::String(cpu, 1).paddedRight(' ', 11)
+   << (juce::String(cpu/(10.*AudioSeconds), 1) + "%").paddedRight(' ', 11)
+   << juce::String(blockTime, 2).paddedRight(' ', 10)
+   << juce::String(blockTime/std::max(1e-9, singleBlockTime), 2) << "x" << std::endl;
+
+   if (!outputsFinite(instances))
+   {
+    std::cout << "FAIL: an instance produced a value that isn't finite" << std::endl;
+    passed = false;
+   }
+   if (count == maximumInstances) break;
+  }
+  return passed;
+ }
+}